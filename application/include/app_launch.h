@@ -3,11 +3,26 @@
 //
 #pragma once
 
+#include "displaylist4cpp.h"
+#include "mesh4cpp.h"
+#include "prim_batch.h"
+#include "scene_graph.h"
 #include "sprite4cpp.h"
+#include <cstddef>
 #include <memory>
-#include <simd/vector_types.h>
+#include <memory_resource>
+#include <simd/simd.h>
+#include <span>
+#include <utility>
+#include <vector>
 
 class CameraData;
+class FrameArena;
+class JobSystem;
+namespace Particle
+{
+class System;
+}
 
 //
 class ApplicationContext
@@ -25,24 +40,127 @@ public:
   virtual void SetTextColor(float red, float green, float blue, float alpha) = 0;
 
   // 2D
+  // 描画順(大きいほど手前)。同じレイヤー内は呼び出し順ではなく 塗り→線→スプライト→文字 の順
+  // (後から塗った矩形でもスプライトの下になるので、上に重ねたい時はレイヤーを分ける)
+  virtual void SetLayer(int layer)                                                              = 0;
   virtual void DrawLine(simd_float2 from, simd_float2 to, simd_float4 color)                    = 0;
   virtual void DrawRect(simd_float2 from, simd_float2 to, simd_float4 color)                    = 0;
   virtual void FillRect(simd_float2 from, simd_float2 to, simd_float4 color)                    = 0;
   virtual void DrawPolygon(simd_float2 pos, float rad, float rot, int sides, simd_float4 color) = 0;
   virtual void FillPolygon(simd_float2 pos, float rad, float rot, int sides, simd_float4 color) = 0;
 
+  // 以降の2D描画を今のクリップ矩形と重なる範囲に制限する(Popと対にする)
+  // 範囲外のものは頂点を作らずに捨て、はみ出したものはシザーで切る
+  virtual void PushClipRect(simd_float2 from, simd_float2 to) = 0;
+  virtual void PopClipRect()                                  = 0;
+
+  // まとめて描画する(頂点領域の確保は1回。足りない時は全て捨てる)
+  virtual void DrawLines(std::span<const Line2D> lines) = 0;
+  virtual void DrawRects(std::span<const Rect2D> rects) = 0;
+  virtual void FillRects(std::span<const Rect2D> rects) = 0;
+
+  // 記録したプリミティブをまとめて描画する(transformはポイント単位のアフィン変換)
+  using DisplayListPtr                       = std::shared_ptr<DisplayListCpp>;
+  virtual DisplayListPtr CreateDisplayList() = 0;
+  virtual void           DrawDisplayList(DisplayListPtr list, simd_float3x2 transform,
+                                         simd_float4 color) = 0;
+  void                   DrawDisplayList(DisplayListPtr list, simd_float2 offset)
+  {
+    auto transform =
+        simd_matrix(simd_make_float2(1.0f, 0.0f), simd_make_float2(0.0f, 1.0f), offset);
+    DrawDisplayList(std::move(list), transform, simd_make_float4(1.0f, 1.0f, 1.0f, 1.0f));
+  }
+
+  // x,yをポイント単位の座標として描画する
+  virtual void DrawParticles(const Particle::System &system) = 0;
+
   using SpritePtr                                   = std::shared_ptr<SpriteCpp>;
   virtual SpritePtr CreateSprite(std::string fname) = 0;
   virtual void      DrawSprite(SpritePtr spr)       = 0;
 
+  // 直前に表示したフレームで描いたスプライトの当たり判定(回転・拡大後の四角形で調べる)
+  // 座標はSetPositionと同じ。結果はGetHandle()の値で、手前にあるものから並ぶ(outは上書き)
+  // 近くにあるものだけを調べるので、スプライトの総数にはほとんど依らない
+  using SpriteHandle = SpriteCpp::Handle;
+
+  virtual void QuerySpritesAt(simd_float2 point, std::vector<SpriteHandle> &out)        = 0;
+  virtual void QuerySpritesInRect(simd_float2 from, simd_float2 to,
+                                  std::vector<SpriteHandle> &out)                       = 0;
+  virtual void QuerySpriteOverlaps(SpriteHandle handle, std::vector<SpriteHandle> &out) = 0;
+  // 重なっている組み合わせ全て(各組は1回だけ)
+  virtual void QuerySpritePairs(std::vector<std::pair<SpriteHandle, SpriteHandle>> &out) = 0;
+
+  // フレーム単位の一時領域(Update終了後に破棄される)
+  // チャンクは使い回すので、温まった後はDraw2Dのフレーム毎のデータでヒープを使わない
+  // ただしPrintは今も毎回NSStringと文字のテクスチャを確保する
+  virtual FrameArena                &GetFrameArena()     = 0;
+  virtual std::pmr::memory_resource *GetFrameAllocator() = 0;
+
+  // 並列処理(runFrame()で投入したジョブはUpdate終了後、描画の前に全て待つ)
+  virtual JobSystem &GetJobSystem() = 0;
+
+  // resource
+  struct ResourceStats
+  {
+    size_t textureCount;   // 管理中のテクスチャ数
+    size_t bytesInUse;     // 参照中
+    size_t bytesCached;    // 未参照(予算超過時に古いものから破棄)
+    size_t bytesTransient; // 文字列など
+    size_t budget;
+    size_t hits; // 以下は直前フレームの値
+    size_t misses;
+    size_t evictions;
+  };
+  virtual void          SetResourceBudget(size_t bytes) = 0;
+  virtual ResourceStats GetResourceStats() const        = 0;
+
+  // 描画内容が前のフレームと同じで描画を省いたフレーム
+  struct FrameSkipStats
+  {
+    size_t skipped;          // 以下2つは累計
+    size_t rendered;
+    size_t consecutive;      // 今続いている数
+    bool   throttled;        // フレームレートを落としている
+    double hashMilliseconds; // 直前フレームのハッシュの計算時間
+  };
+  virtual FrameSkipStats GetFrameSkipStats() const = 0;
+
   // 3D
   virtual CameraData &GetCamera() = 0;
 
+  // ワールド座標を2D描画の座標(ポイント単位)に変換する(3Dの物に文字や印を重ねる時など)
+  // カメラのnearより奥にある点はvisibleが1になる。0の点のscreenは使えない。戻り値は1の数
+  virtual size_t ProjectToScreen(std::span<const simd_float3> points, std::span<simd_float2> screen,
+                                 std::span<uint8_t> visible) = 0;
+
+  // 直前フレームの半透明の三角形の数と並べ替えの時間
+  struct TranslucentStats
+  {
+    size_t triangles;
+    double sortMilliseconds;
+  };
+  virtual TranslucentStats GetTranslucentStats() const = 0;
+
   virtual void DrawLine3D(simd_float3 from, simd_float3 to, simd_float4 color) = 0;
+  // 三角形はcolorのアルファが1未満なら半透明として不透明の後に奥から順に描画する
   virtual void DrawTriangle3D(simd_float3 p0, simd_float3 p1, simd_float3 p2,
                               simd_float4 color)                               = 0;
   virtual void DrawPlane3D(simd_float3 p0, simd_float3 p1, simd_float3 p2, simd_float3 p3,
                            simd_float4 color)                                  = 0;
+  // まとめて描画する。colorsは1色(全て同じ色)かtrianglesと同じ数
+  virtual void DrawLines3D(std::span<const Line3D> lines) = 0;
+  virtual void DrawTriangles3D(std::span<const Triangle3D>  triangles,
+                               std::span<const simd_float4> colors) = 0;
+  // 記録した三角形をモデル行列で変換して描画する(colorは頂点カラーに乗算)
+  using MeshPtr                = std::shared_ptr<MeshCpp>;
+  virtual MeshPtr CreateMesh() = 0;
+  virtual void    DrawMesh(MeshPtr mesh, const simd_float4x4 &model, simd_float4 color) = 0;
+  void DrawMesh(MeshPtr mesh, const Scene::Graph &graph, Scene::NodeId node, simd_float4 color)
+  {
+    DrawMesh(std::move(mesh), graph.world(node), color);
+  }
+  // カメラに正対する四角形で描画する
+  virtual void DrawParticles3D(const Particle::System &system) = 0;
 };
 
 //
@@ -64,6 +182,14 @@ public:
   // resize window
   virtual void ResizeWindow(double width, double height) {}
 
+  // 描画内容(頂点・文字列・スプライト・カメラ)が前のフレームと同じなら描画を省く(既定は無効)
+  // 画面には前に表示したものがそのまま残る
+  // テクスチャの中身だけを書き換えた場合(renderImage:など)は変化として扱われないので注意
+  [[nodiscard]] virtual bool SkipUnchangedFrames() const { return false; }
+  // 省いたフレームが続いている間のフレームレート(0なら落とさない)
+  // 落としている間はUpdateもこの頻度になり、描画内容が変わると元に戻す
+  [[nodiscard]] virtual int IdleFrameRate() const { return 0; }
+
   // main update loop
   virtual void Update(ApplicationContext &ctx) = 0;
 };
@@ -0,0 +1,21 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <simd/vector_types.h>
+
+// 2Dプリミティブの記録(ApplicationContext::DrawDisplayListで何度でも描画できる)
+class DisplayListCpp
+{
+public:
+  DisplayListCpp()          = default;
+  virtual ~DisplayListCpp() = default;
+
+  virtual void Clear()                                                                          = 0;
+  virtual void DrawLine(simd_float2 from, simd_float2 to, simd_float4 color)                    = 0;
+  virtual void DrawRect(simd_float2 from, simd_float2 to, simd_float4 color)                    = 0;
+  virtual void FillRect(simd_float2 from, simd_float2 to, simd_float4 color)                    = 0;
+  virtual void DrawPolygon(simd_float2 pos, float rad, float rot, int sides, simd_float4 color) = 0;
+  virtual void FillPolygon(simd_float2 pos, float rad, float rot, int sides, simd_float4 color) = 0;
+};
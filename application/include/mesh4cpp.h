@@ -0,0 +1,19 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <simd/vector_types.h>
+
+// 3Dの三角形の記録(ApplicationContext::DrawMeshでモデル行列を変えて何度でも描画できる)
+class MeshCpp
+{
+public:
+  MeshCpp()          = default;
+  virtual ~MeshCpp() = default;
+
+  virtual void Clear()                                                                         = 0;
+  virtual void DrawTriangle(simd_float3 p0, simd_float3 p1, simd_float3 p2, simd_float4 color) = 0;
+  virtual void DrawPlane(simd_float3 p0, simd_float3 p1, simd_float3 p2, simd_float3 p3,
+                         simd_float4 color)                                                    = 0;
+};
@@ -3,6 +3,14 @@
 //
 #pragma once
 
+#include <cstdint>
+#include <memory>
+
+namespace ImageFilter
+{
+class Graph;
+}
+
 class SpriteCpp
 {
 public:
@@ -19,14 +27,20 @@ public:
     CenterBottom,
   };
 
+  // 当たり判定の結果と比べる番号(0は無効)
+  using Handle = uint32_t;
+
   SpriteCpp()          = default;
   virtual ~SpriteCpp() = default;
 
-  virtual bool IsLoaded() const = 0;
+  virtual bool   IsLoaded() const  = 0;
+  virtual Handle GetHandle() const = 0;
 
   virtual void SetAlign(Align align)                                         = 0;
   virtual void SetScale(float scale)                                         = 0;
   virtual void SetRotate(float rotate)                                       = 0;
   virtual void SetPosition(float x, float y)                                 = 0;
   virtual void SetFaceColor(float red, float green, float blue, float alpha) = 0;
+  // CPUフィルタ(グラフはスプライト毎に用意する)
+  virtual void SetImageFilter(std::shared_ptr<ImageFilter::Graph> graph) = 0;
 };
@@ -4,16 +4,26 @@
 #import "renderer.h"
 #include "app_launch.h"
 #import "camera.h"
+#import "display_list.h"
+#include "displaylist4cpp.h"
 #import "draw2d.h"
 #import "draw3d.h"
+#include "frame_arena.h"
+#include "frame_hash.h"
+#include "job_system.h"
+#import "mesh3d.h"
+#include "mesh4cpp.h"
 #import "sprite.h"
 #include "sprite4cpp.h"
 #include <AppKit/AppKit.h>
 #import <Metal/Metal.h>
+#include <chrono>
 #include <memory>
 #import <simd/simd.h>
 
 static const NSUInteger MaxBuffersInFlight = 3;
+// 描画を省いたフレームがこれだけ続いたらフレームレートを落とす
+static const size_t IdleAfterFrames = 30;
 
 //
 class SpriteImpl : public SpriteCpp
@@ -24,11 +34,15 @@ public:
   SpriteImpl(NSArray<Sprite *> *sprl) : sprPtr_(sprl) {}
   ~SpriteImpl() override
   {
-    [sprPtr_[0] release];
+    if ([sprPtr_ count] > 0)
+    {
+      [sprPtr_[0] release];
+    }
     [sprPtr_ release];
   }
 
-  bool IsLoaded() const override { return [sprPtr_ count] > 0 && sprPtr_[0]; }
+  bool   IsLoaded() const override { return [sprPtr_ count] > 0 && sprPtr_[0]; }
+  Handle GetHandle() const override { return IsLoaded() ? sprPtr_[0].handle : 0; }
 
   void SetAlign(Align align) override { sprPtr_[0].align = (SpriteAlign)align; }
   void SetScale(float scale) override { sprPtr_[0].scale = scale; }
@@ -38,17 +52,80 @@ public:
   {
     sprPtr_[0].color = simd_make_float4(red, green, blue, alpha);
   }
+  void SetImageFilter(std::shared_ptr<ImageFilter::Graph> graph) override
+  {
+    [sprPtr_[0] setImageFilter:std::move(graph)];
+  }
 
   Sprite *GetSprite() { return sprPtr_[0]; }
 };
 
+//
+class DisplayListImpl : public DisplayListCpp
+{
+  DisplayList2D *list_;
+
+public:
+  DisplayListImpl(DisplayList2D *list) : list_(list) {}
+  ~DisplayListImpl() override { [list_ release]; }
+
+  void Clear() override { [list_ clear]; }
+  void DrawLine(simd_float2 from, simd_float2 to, simd_float4 color) override
+  {
+    [list_ drawLine:from to:to color:color];
+  }
+  void DrawRect(simd_float2 from, simd_float2 to, simd_float4 color) override
+  {
+    [list_ drawRect:from to:to color:color];
+  }
+  void FillRect(simd_float2 from, simd_float2 to, simd_float4 color) override
+  {
+    [list_ fillRect:from to:to color:color];
+  }
+  void DrawPolygon(simd_float2 pos, float rad, float rot, int sides, simd_float4 color) override
+  {
+    [list_ drawPolygon:pos radius:rad rotate:rot numSides:sides color:color];
+  }
+  void FillPolygon(simd_float2 pos, float rad, float rot, int sides, simd_float4 color) override
+  {
+    [list_ fillPolygon:pos radius:rad rotate:rot numSides:sides color:color];
+  }
+
+  DisplayList2D *GetList() { return list_; }
+};
+
+//
+class MeshImpl : public MeshCpp
+{
+  Mesh3D *mesh_;
+
+public:
+  MeshImpl(Mesh3D *mesh) : mesh_(mesh) {}
+  ~MeshImpl() override { [mesh_ release]; }
+
+  void Clear() override { [mesh_ clear]; }
+  void DrawTriangle(simd_float3 p0, simd_float3 p1, simd_float3 p2, simd_float4 color) override
+  {
+    [mesh_ drawTriangle:p0 p1:p1 p2:p2 color:color];
+  }
+  void DrawPlane(simd_float3 p0, simd_float3 p1, simd_float3 p2, simd_float3 p3,
+                 simd_float4 color) override
+  {
+    [mesh_ drawPlane:p0 p1:p1 p2:p2 p3:p3 color:color];
+  }
+
+  Mesh3D *GetMesh() { return mesh_; }
+};
+
 //
 class AppCtx : public ApplicationContext
 {
 public:
-  Draw2D     *draw2d_;
-  Draw3D     *draw3d_;
-  CameraData *camera_;
+  Draw2D        *draw2d_;
+  Draw3D        *draw3d_;
+  CameraData    *camera_;
+  FrameArena     frameArena_;
+  FrameSkipStats skipStats_{};
 
   AppCtx()           = default;
   ~AppCtx() override = default;
@@ -64,6 +141,8 @@ public:
     [draw2d_ setTextColorRed:red green:green blue:blue alpha:alpha];
   }
 
+  void SetLayer(int layer) override { draw2d_.layer = layer; }
+
   void DrawLine(simd_float2 from, simd_float2 to, simd_float4 color) override
   {
     [draw2d_ drawLine:from to:to color:color];
@@ -86,8 +165,80 @@ public:
     [draw2d_ fillRect:from to:to color:color];
   }
 
+  void PushClipRect(simd_float2 from, simd_float2 to) override
+  {
+    [draw2d_ pushClipRect:from to:to];
+  }
+  void PopClipRect() override { [draw2d_ popClipRect]; }
+
+  void DrawLines(std::span<const Line2D> lines) override
+  {
+    [draw2d_ drawLines:lines.data() count:lines.size()];
+  }
+  void DrawRects(std::span<const Rect2D> rects) override
+  {
+    [draw2d_ drawRects:rects.data() count:rects.size()];
+  }
+  void FillRects(std::span<const Rect2D> rects) override
+  {
+    [draw2d_ fillRects:rects.data() count:rects.size()];
+  }
+
+  DisplayListPtr CreateDisplayList() override
+  {
+    return std::make_shared<DisplayListImpl>([draw2d_ newDisplayList]);
+  }
+  void DrawDisplayList(DisplayListPtr list, simd_float3x2 transform, simd_float4 color) override
+  {
+    if (auto impl = std::dynamic_pointer_cast<DisplayListImpl>(list))
+    {
+      [draw2d_ drawDisplayList:impl->GetList() transform:transform color:color];
+    }
+  }
+
+  void DrawParticles(const Particle::System &system) override
+  {
+    [draw2d_ drawParticles:system];
+  }
+
+  FrameArena                &GetFrameArena() override { return frameArena_; }
+  std::pmr::memory_resource *GetFrameAllocator() override { return frameArena_.resource(); }
+
+  JobSystem &GetJobSystem() override { return JobSystem::Default(); }
+
+  void SetResourceBudget(size_t bytes) override { draw2d_.textureCache.budget = bytes; }
+  ResourceStats GetResourceStats() const override
+  {
+    auto          stats = [draw2d_.textureCache stats];
+    ResourceStats result;
+    result.textureCount   = stats.textureCount;
+    result.bytesInUse     = stats.bytesInUse;
+    result.bytesCached    = stats.bytesCached;
+    result.bytesTransient = stats.bytesTransient;
+    result.budget         = stats.budget;
+    result.hits           = stats.hits;
+    result.misses         = stats.misses;
+    result.evictions      = stats.evictions;
+    return result;
+  }
+
+  FrameSkipStats GetFrameSkipStats() const override { return skipStats_; }
+
   CameraData &GetCamera() override { return *camera_; }
 
+  size_t ProjectToScreen(std::span<const simd_float3> points, std::span<simd_float2> screen,
+                         std::span<uint8_t> visible) override
+  {
+    auto size = draw2d_.screenSize;
+    auto pt   = simd_make_float2(size.width, size.height) / ContentScale();
+    return camera_->projectToScreen(points, pt, screen, visible);
+  }
+
+  TranslucentStats GetTranslucentStats() const override
+  {
+    return {draw3d_.lastTranslucentCount, draw3d_.lastTranslucentSortTime};
+  }
+
   void DrawLine3D(simd_float3 from, simd_float3 to, simd_float4 color) override
   {
     [draw3d_ drawLine:from to:to color:color];
@@ -101,6 +252,34 @@ public:
   {
     [draw3d_ drawPlane:p0 p1:p1 p2:p2 p3:p3 color:color];
   }
+  void DrawLines3D(std::span<const Line3D> lines) override
+  {
+    [draw3d_ drawLines:lines.data() count:lines.size()];
+  }
+  void DrawTriangles3D(std::span<const Triangle3D>  triangles,
+                       std::span<const simd_float4> colors) override
+  {
+    if (colors.empty())
+    {
+      return;
+    }
+    [draw3d_ drawTriangles:triangles.data()
+                     count:triangles.size()
+                    colors:colors.data()
+                colorCount:colors.size()];
+  }
+  MeshPtr CreateMesh() override { return std::make_shared<MeshImpl>([draw3d_ newMesh]); }
+  void    DrawMesh(MeshPtr mesh, const simd_float4x4 &model, simd_float4 color) override
+  {
+    if (auto impl = std::dynamic_pointer_cast<MeshImpl>(mesh))
+    {
+      [draw3d_ drawMesh:impl->GetMesh() transform:model color:color];
+    }
+  }
+  void DrawParticles3D(const Particle::System &system) override
+  {
+    [draw3d_ drawParticles:system];
+  }
 
   SpritePtr CreateSprite(std::string fname) override
   {
@@ -108,11 +287,14 @@ public:
 
     NSArray<NSString *> *fnarr = @[ fnstr ];
 
-    if (auto sprList = [draw2d_ createSprites:fnarr])
+    // 読み込めなければ空の配列が返る
+    auto sprList = [draw2d_ createSprites:fnarr];
+    if ([sprList count] == 0)
     {
-      return std::make_shared<SpriteImpl>(sprList);
+      [sprList release];
+      return {};
     }
-    return {};
+    return std::make_shared<SpriteImpl>(sprList);
   }
   void DrawSprite(SpritePtr spr) override
   {
@@ -124,6 +306,23 @@ public:
       }
     }
   }
+  void QuerySpritesAt(simd_float2 point, std::vector<SpriteHandle> &out) override
+  {
+    [draw2d_ querySpritesAt:point result:out];
+  }
+  void QuerySpritesInRect(simd_float2 from, simd_float2 to,
+                          std::vector<SpriteHandle> &out) override
+  {
+    [draw2d_ querySpritesIn:from to:to result:out];
+  }
+  void QuerySpriteOverlaps(SpriteHandle handle, std::vector<SpriteHandle> &out) override
+  {
+    [draw2d_ querySpriteOverlaps:handle result:out];
+  }
+  void QuerySpritePairs(std::vector<std::pair<SpriteHandle, SpriteHandle>> &out) override
+  {
+    [draw2d_ querySpritePairs:out];
+  }
 };
 
 @implementation Renderer
@@ -136,10 +335,16 @@ public:
   id<MTLDepthStencilState> depthState_;
 
   ApplicationLoop *appLoop_;
+  AppCtx          *appCtx_;
 
   CameraData camera_;
   Draw2D    *draw2d_;
   Draw3D    *draw3d_;
+
+  // 前のフレームの描画内容
+  uint64_t  lastHash_;
+  BOOL      hasLastHash_;
+  NSInteger normalFrameRate_;
 }
 
 + (id<MTLLibrary>)createShaderLibrary:(id<MTLDevice>)device fromName:(NSString *)libraryName
@@ -176,6 +381,16 @@ public:
     draw2d_        = [[Draw2D alloc] initWithMetalKitView:view shaderlib:shaderLibrary_];
     draw3d_        = [[Draw3D alloc] initWithMetalKitView:view shaderlib:shaderLibrary_];
 
+    // 毎フレーム使い回す
+    appCtx_          = new AppCtx();
+    appCtx_->draw2d_ = draw2d_;
+    appCtx_->draw3d_ = draw3d_;
+    appCtx_->camera_ = &camera_;
+
+    lastHash_        = 0;
+    hasLastHash_     = NO;
+    normalFrameRate_ = 0;
+
     //
 
     auto depthStateDesc                 = [[MTLDepthStencilDescriptor alloc] init];
@@ -189,16 +404,88 @@ public:
 
 - (void)dealloc
 {
+  delete appCtx_;
   [depthState_ release];
   [draw2d_ release];
   [draw3d_ release];
   [super dealloc];
 }
 
+// 描画を省くのをやめてフレームレートを戻す
+- (void)endIdle:(nonnull MTKView *)view
+{
+  auto &stats       = appCtx_->skipStats_;
+  stats.consecutive = 0;
+  if (stats.throttled)
+  {
+    view.preferredFramesPerSecond = normalFrameRate_;
+    stats.throttled               = false;
+  }
+}
+
+// 描画内容が前のフレームと同じか(同じ間は必要ならフレームレートを落とす)
+- (BOOL)isUnchangedFrame:(nonnull MTKView *)view
+{
+  auto &stats = appCtx_->skipStats_;
+  if (!appLoop_->SkipUnchangedFrames())
+  {
+    hasLastHash_ = NO;
+    [self endIdle:view];
+    return NO;
+  }
+
+  auto      start = std::chrono::steady_clock::now();
+  FrameHash hash;
+  hash.add([draw2d_ frameHash]);
+  hash.add([draw3d_ frameHash]);
+  hash.add(camera_.getProjectionMatrix());
+  hash.add(camera_.getModelViewMatrix());
+  hash.add(view.drawableSize);
+  hash.add(view.clearColor);
+  auto value = hash.digest();
+  stats.hashMilliseconds =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  BOOL same    = hasLastHash_ && value == lastHash_;
+  lastHash_    = value;
+  hasLastHash_ = YES;
+  if (!same)
+  {
+    [self endIdle:view];
+    return NO;
+  }
+
+  stats.skipped++;
+  stats.consecutive++;
+  auto idleRate = appLoop_->IdleFrameRate();
+  if (idleRate > 0 && !stats.throttled && stats.consecutive >= IdleAfterFrames)
+  {
+    normalFrameRate_              = view.preferredFramesPerSecond;
+    view.preferredFramesPerSecond = idleRate;
+    stats.throttled               = true;
+  }
+  return YES;
+}
+
 - (void)drawInMTKView:(nonnull MTKView *)view
 {
   dispatch_semaphore_wait(renderSemaphore_, DISPATCH_TIME_FOREVER);
 
+  appLoop_->Update(*appCtx_);
+  // 一時領域を破棄する前に、このフレームのジョブを全て終わらせる
+  JobSystem::Default().endFrame();
+  appCtx_->frameArena_.reset();
+
+  // 前のフレームと同じなら何もGPUに渡さない(前に表示したものがそのまま残る)
+  if ([self isUnchangedFrame:view])
+  {
+    [draw3d_ discardFrame];
+    [draw2d_ discardFrame];
+    dispatch_semaphore_signal(renderSemaphore_);
+    return;
+  }
+  appCtx_->skipStats_.rendered++;
+
   uniformBufferIndex_ = (uniformBufferIndex_ + 1) % MaxBuffersInFlight;
 
   id<MTLCommandBuffer> commandBuffer = [commandQueue_ commandBuffer];
@@ -209,12 +496,6 @@ public:
     dispatch_semaphore_signal(block_sema);
   }];
 
-  AppCtx appctx;
-  appctx.draw2d_ = draw2d_;
-  appctx.draw3d_ = draw3d_;
-  appctx.camera_ = &camera_;
-  appLoop_->Update(appctx);
-
   // render
   auto renderPassDescriptor = view.currentRenderPassDescriptor;
 
@@ -239,6 +520,13 @@ public:
     [renderEncoder endEncoding];
     [commandBuffer presentDrawable:view.currentDrawable];
   }
+  else
+  {
+    // 表示していないので積んだ内容は捨て、次のフレームは比べずに描画する
+    [draw3d_ discardFrame];
+    [draw2d_ discardFrame];
+    hasLastHash_ = NO;
+  }
 
   [commandBuffer commit];
 }
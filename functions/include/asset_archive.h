@@ -0,0 +1,106 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+//
+// テクスチャアーカイブ(tools/assetpackで生成)
+//
+// [ArchiveHeader][ArchiveEntry x tableSize][名前文字列][テクスチャデータ...]
+// ディレクトリはパス名のハッシュによるオープンアドレス法のテーブル
+// テクスチャデータはページ境界、各行はRowAlignmentに揃えてありそのままGPUへ転送できる
+//
+namespace AssetArchive
+{
+constexpr uint32_t Magic         = 0x4b50544d; // "MTPK"
+constexpr uint32_t Version       = 1;
+constexpr uint32_t RowAlignment  = 256;
+constexpr uint32_t DataAlignment = 4096;
+
+enum class PixelFormat : uint32_t
+{
+  RGBA8Unorm_sRGB = 0,
+  RGBA8Unorm      = 1,
+};
+
+struct ArchiveHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entryCount;
+  uint32_t tableSize; // 2のべき乗
+  uint64_t tableOffset;
+  uint64_t stringOffset;
+};
+
+struct ArchiveEntry
+{
+  uint64_t hash; // 0は空きスロット
+  uint32_t nameOffset;
+  uint32_t nameLength;
+  uint32_t width;
+  uint32_t height;
+  uint32_t format;
+  uint32_t mipLevels;
+  uint64_t dataOffset;
+  uint64_t dataSize;
+};
+
+struct ImageLevel
+{
+  const uint8_t *data;
+  uint32_t       width;
+  uint32_t       height;
+  uint32_t       bytesPerRow;
+};
+
+//
+inline uint64_t HashName(std::string_view name)
+{
+  // FNV-1a
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (auto ch : name)
+  {
+    hash ^= static_cast<uint8_t>(ch);
+    hash *= 0x100000001b3ull;
+  }
+  return hash != 0 ? hash : 1;
+}
+
+inline uint32_t AlignedRowBytes(uint32_t width)
+{
+  return (width * 4 + RowAlignment - 1) & ~(RowAlignment - 1);
+}
+
+//
+// mmapしたアーカイブの読み出し
+//
+class Reader final
+{
+  int                  fd_     = -1;
+  const uint8_t       *base_   = nullptr;
+  size_t               size_   = 0;
+  const ArchiveHeader *header_ = nullptr;
+  const ArchiveEntry  *table_  = nullptr;
+
+  [[nodiscard]] bool isValid(const ArchiveEntry &entry) const;
+
+public:
+  Reader() = default;
+  ~Reader();
+  Reader(const Reader &)            = delete;
+  Reader &operator=(const Reader &) = delete;
+
+  bool open(const char *path);
+  void close();
+
+  [[nodiscard]] bool                isOpen() const { return header_ != nullptr; }
+  [[nodiscard]] const ArchiveEntry *find(std::string_view name) const;
+  [[nodiscard]] ImageLevel          getLevel(const ArchiveEntry &entry, uint32_t level) const;
+};
+
+} // namespace AssetArchive
@@ -3,7 +3,10 @@
 //
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <simd/simd.h>
+#include <span>
 
 class CameraData final
 {
@@ -17,6 +20,10 @@ class CameraData final
   float           znear_;
   float           zfar_;
 
+  // projection_ * modelview_(変更後に初めて使う時に計算する)
+  mutable matrix_float4x4 viewProjection_;
+  mutable bool            viewProjectionDirty_;
+
 public:
   CameraData();
   ~CameraData();
@@ -26,9 +33,20 @@ public:
   //
   [[nodiscard]] matrix_float4x4 getProjectionMatrix() const { return projection_; }
   [[nodiscard]] matrix_float4x4 getModelViewMatrix() const { return modelview_; }
+  // カメラを変えた後の最初の呼び出しは並列に行わないこと
+  [[nodiscard]] const matrix_float4x4 &getViewProjectionMatrix() const;
   [[nodiscard]] simd_float3     getEyePosition() const { return eyePoint_; }
   [[nodiscard]] simd_float3     getLookAt() const { return lookAt_; }
   [[nodiscard]] simd_float3     getUpDirection() const { return upDir_; }
   [[nodiscard]] float           getAspect() const { return aspect_; }
   [[nodiscard]] float           getFieldOfView() const { return fovy_; }
+  // ビュー空間の右・上方向(ワールド座標)
+  [[nodiscard]] simd_float3 getViewRight() const;
+  [[nodiscard]] simd_float3 getViewUp() const;
+
+  // ワールド座標を画面の座標(左上が原点でyは下向き。primVert2dの頂点と同じ)に変換する
+  // screenSizeは結果の単位での画面の大きさ。nearより奥にある点はvisibleが1になる
+  // visibleが0の点のscreenは使えない。数は3つのうち一番短いものに合わせ、戻り値はvisibleが1の数
+  size_t projectToScreen(std::span<const simd_float3> points, simd_float2 screenSize,
+                         std::span<simd_float2> screen, std::span<uint8_t> visible) const;
 };
@@ -0,0 +1,38 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#import <Metal/Metal.h>
+#include <simd/vector_types.h>
+
+//
+// 2Dプリミティブを記録しておき、変換とカラーを変えて何度でも描画できるリスト
+// 座標はDraw2Dと同じ(ポイント単位)。頂点は最初の描画時にGPUバッファへまとめて転送する
+//
+@interface DisplayList2D : NSObject
+
+@property(readonly) NSUInteger fillVertexCount;
+@property(readonly) NSUInteger lineVertexCount;
+// 記録した頂点を囲む矩形(min.xy, max.xy)。空なら全て0
+@property(readonly) simd_float4 bounds;
+// vertexBufferを作り直す度に変わる(全てのリストで一意)
+@property(readonly) uint64_t revision;
+
+- (nonnull instancetype)initWithDevice:(nonnull id<MTLDevice>)device;
+- (void)clear;
+- (void)drawLine:(simd_float2)from to:(simd_float2)to color:(simd_float4)color;
+- (void)drawRect:(simd_float2)from to:(simd_float2)to color:(simd_float4)color;
+- (void)drawPolygon:(simd_float2)pos
+             radius:(float)rad
+             rotate:(float)rot
+           numSides:(int)sides
+              color:(simd_float4)color;
+- (void)fillRect:(simd_float2)from to:(simd_float2)to color:(simd_float4)color;
+- (void)fillPolygon:(simd_float2)pos
+             radius:(float)rad
+             rotate:(float)rot
+           numSides:(int)sides
+              color:(simd_float4)color;
+// 塗り→線の順に詰めたバッファ(記録が変わった時だけ作り直す)
+- (nullable id<MTLBuffer>)vertexBuffer;
+
+@end
@@ -1,17 +1,31 @@
 //
 // Copyright 2024 Y.Suzuki(wave.suzuki.z@gmail.com)
 //
+#import "display_list.h"
+#include "particle_system.h"
+#include "prim_batch.h"
 #import "sprite.h"
+#import "texture_cache.h"
 #import <MetalKit/MetalKit.h>
+#include <simd/matrix_types.h>
 #include <simd/vector_types.h>
+#include <utility>
+#include <vector>
 
 @interface Draw2D : NSObject
 
-@property CGSize screenSize;
+@property CGSize                             screenSize;
+@property(readonly, nonnull) TextureCache *textureCache;
+// 描画順(大きいほど手前)。同じレイヤー内は 塗り→線→スプライト→文字 の順
+@property int layer;
 
 - (nonnull instancetype)initWithMetalKitView:(nonnull MTKView *)view
                                    shaderlib:(nonnull id<MTLLibrary>)library;
 - (void)render:(nullable id<MTLRenderCommandEncoder>)renderEncoder;
+// このフレームで積んだ描画内容のハッシュ(同じなら同じ絵になる)
+- (uint64_t)frameHash;
+// 描画せずにこのフレームの内容を捨てる
+- (void)discardFrame;
 - (void)setTextColorRed:(CGFloat)red green:(CGFloat)green blue:(CGFloat)blue alpha:(CGFloat)alpha;
 - (void)print:(nonnull NSString *)message x:(CGFloat)x y:(CGFloat)y keep:(BOOL)keep;
 - (void)print:(nonnull NSString *)message x:(CGFloat)x y:(CGFloat)y;
@@ -28,8 +42,31 @@
              rotate:(float)rot
            numSides:(int)sides
               color:(simd_float4)color;
+// 以降の描画を今のクリップ矩形と重なる範囲に制限する(ポイント単位)
+// クリップ(無ければ画面)の外にあるものは頂点を作らない。スタックはフレーム毎に空に戻る
+- (void)pushClipRect:(simd_float2)from to:(simd_float2)to;
+- (void)popClipRect;
+// まとめて描画する(頂点領域が足りない時は全て捨てる)
+- (void)drawLines:(nonnull const Line2D *)lines count:(NSUInteger)count;
+- (void)drawRects:(nonnull const Rect2D *)rects count:(NSUInteger)count;
+- (void)fillRects:(nonnull const Rect2D *)rects count:(NSUInteger)count;
+// 記録用のリストを作る(+1)
+- (nonnull DisplayList2D *)newDisplayList;
+// 変換はポイント単位の座標に対するアフィン変換、カラーは乗算
+- (void)drawDisplayList:(nonnull DisplayList2D *)list
+              transform:(simd_float3x2)transform
+                  color:(simd_float4)color;
+// x,yをポイント単位の座標として描画する(zは使わない)
+- (void)drawParticles:(const Particle::System &)system;
 - (nonnull NSArray<Sprite *> *)createSprites:(nonnull NSArray<NSString *> *)fileList;
 - (nonnull NSArray<Sprite *> *)createSpritesByImage:(nonnull NSArray<NSString *> *)fileList;
 - (void)drawSprite:(nonnull Sprite *)sprite;
+// 直前に表示したフレームで描いたスプライトを回転・拡大後の四角形で調べる(クリップで隠れたものも含む)
+// 座標はスプライトと同じピクセル単位。結果はSpriteのhandleで、手前にあるものから並ぶ
+- (void)querySpritesAt:(simd_float2)point result:(std::vector<uint32_t> &)result;
+- (void)querySpritesIn:(simd_float2)from to:(simd_float2)to result:(std::vector<uint32_t> &)result;
+- (void)querySpriteOverlaps:(uint32_t)handle result:(std::vector<uint32_t> &)result;
+// 重なっている組み合わせ全て(各組は1回だけ)
+- (void)querySpritePairs:(std::vector<std::pair<uint32_t, uint32_t>> &)result;
 
 @end
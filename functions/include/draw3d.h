@@ -2,21 +2,46 @@
 // Copyright 2024 Y.Suzuki(wave.suzuki.z@gmail.com)
 //
 #import "camera.h"
+#import "mesh3d.h"
+#include "particle_system.h"
+#include "prim_batch.h"
 #import <MetalKit/MetalKit.h>
 #include <simd/vector_types.h>
 
 @interface Draw3D : NSObject
 
+// 直前のフレームで描画した半透明の三角形の数と、並べ替えにかかった時間(ミリ秒)
+@property(readonly) NSUInteger lastTranslucentCount;
+@property(readonly) double     lastTranslucentSortTime;
+
 - (nonnull instancetype)initWithMetalKitView:(nonnull MTKView *)view
                                    shaderlib:(nonnull id<MTLLibrary>)library;
 - (void)render:(nullable id<MTLRenderCommandEncoder>)renderEncoder
         camera:(nonnull CameraData *)camera;
+// このフレームで積んだ描画内容のハッシュ(カメラは含まない)
+- (uint64_t)frameHash;
+// 描画せずにこのフレームの内容を捨てる
+- (void)discardFrame;
 - (void)drawLine:(simd_float3)from to:(simd_float3)to color:(simd_float4)color;
+// アルファが1未満の三角形は不透明の後に奥から順に描画する(奥行きは書き込まない)
 - (void)drawTriangle:(simd_float3)p0 p1:(simd_float3)p1 p2:(simd_float3)p2 color:(simd_float4)color;
 - (void)drawPlane:(simd_float3)p0
                p1:(simd_float3)p1
                p2:(simd_float3)p2
                p3:(simd_float3)p3
             color:(simd_float4)color;
+// まとめて描画する(頂点領域が足りない時は全て捨てる)
+- (void)drawLines:(nonnull const Line3D *)lines count:(NSUInteger)count;
+// colorCountは1(全て同じ色)かcountと同じ数
+- (void)drawTriangles:(nonnull const Triangle3D *)triangles
+                count:(NSUInteger)count
+               colors:(nonnull const simd_float4 *)colors
+           colorCount:(NSUInteger)colorCount;
+// 記録用のメッシュを作る(+1)
+- (nonnull Mesh3D *)newMesh;
+// modelはワールド行列(Scene::Graph::world()など)。colorは頂点カラーに乗算する
+- (void)drawMesh:(nonnull Mesh3D *)mesh transform:(simd_float4x4)model color:(simd_float4)color;
+// カメラに正対する四角形で描画する
+- (void)drawParticles:(const Particle::System &)system;
 
 @end
@@ -0,0 +1,107 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//
+// フレーム単位の一時領域(バンプアロケータ)
+// スレッド毎にチャンクを持つので割り当て時にロックしない
+// reset()で全て破棄するが、チャンクは解放せずに次のフレームで再利用する
+//
+class FrameArena
+{
+public:
+  struct Stats
+  {
+    size_t bytesUsed;        // 現在のフレームで割り当てた量
+    size_t bytesReserved;    // 確保済みチャンクの合計
+    size_t peakBytes;        // reset時点の最大使用量
+    size_t chunkAllocations; // チャンクを確保した回数(累計)
+  };
+
+private:
+  struct Chunk
+  {
+    std::unique_ptr<std::byte[]> data;
+    size_t                       size;
+  };
+  // usedとreservedは持ち主のスレッドだけが書き、stats()が他のスレッドから読む
+  struct Slot
+  {
+    std::vector<Chunk>  chunks;
+    size_t              current = 0;
+    size_t              offset  = 0;
+    std::atomic<size_t> used{0};
+    std::atomic<size_t> reserved{0};
+  };
+
+  // pmr用(解放は何もしない)
+  class Resource : public std::pmr::memory_resource
+  {
+    FrameArena &arena_;
+
+  public:
+    explicit Resource(FrameArena &arena) : arena_(arena) {}
+
+  protected:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+      return arena_.allocate(bytes, alignment);
+    }
+    void do_deallocate(void *, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+      return this == &other;
+    }
+  };
+
+  const uint64_t                              id_;
+  size_t                                      chunkSize_;
+  std::mutex                                  mutex_;
+  std::vector<std::unique_ptr<Slot>>          slots_;
+  std::unordered_map<std::thread::id, Slot *> slotMap_;
+  std::atomic<size_t>                         chunkAllocations_{0};
+  size_t                                      peakBytes_ = 0;
+  Resource                                    resource_;
+
+  Slot *localSlot();
+
+public:
+  explicit FrameArena(size_t chunkSize = 256 * 1024);
+  ~FrameArena();
+  FrameArena(const FrameArena &)            = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+  // デストラクタは呼ばれないので、必要なら呼び出し側で呼ぶ
+  template <class T, class... Args>
+  T *create(Args &&...args)
+  {
+    return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+  template <class T>
+  T *allocateArray(size_t count)
+  {
+    return static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+  }
+
+  // 全スレッドの割り当てを破棄する(他のスレッドが割り当て中でないこと)
+  void reset();
+
+  [[nodiscard]] std::pmr::memory_resource *resource() { return &resource_; }
+  // 割り当て中に呼んでもよい(その時点の近似値)
+  [[nodiscard]] Stats                      stats();
+};
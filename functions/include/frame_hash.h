@@ -0,0 +1,169 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+//
+// フレームの描画内容を比べるためのハッシュ(XXH64と同じ値になる)
+// 32バイト毎に4つのレーンを独立に進めるので、頂点データのようなまとまった入力なら
+// メモリの読み出しと同程度の速さで済む。少しずつ渡しても結果は変わらない
+//
+class FrameHash
+{
+  static constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+  static constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+  static constexpr uint64_t Prime3 = 0x165667B19E3779F9ULL;
+  static constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ULL;
+  static constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ULL;
+
+  uint64_t lane_[4];
+  uint8_t  pending_[32];
+  size_t   pendingSize_;
+  uint64_t total_;
+  uint64_t seed_;
+
+  static uint64_t Rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+  static uint64_t Read64(const uint8_t *p)
+  {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+  static uint32_t Read32(const uint8_t *p)
+  {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+  static uint64_t Round(uint64_t acc, uint64_t input)
+  {
+    acc += input * Prime2;
+    return Rotl(acc, 31) * Prime1;
+  }
+  static uint64_t Merge(uint64_t acc, uint64_t lane)
+  {
+    acc ^= Round(0, lane);
+    return acc * Prime1 + Prime4;
+  }
+
+  // 32バイト単位で処理する(末尾の端数のバイト数を返す)
+  size_t consume(const uint8_t *p, size_t size)
+  {
+    while (size >= 32)
+    {
+      lane_[0] = Round(lane_[0], Read64(p + 0));
+      lane_[1] = Round(lane_[1], Read64(p + 8));
+      lane_[2] = Round(lane_[2], Read64(p + 16));
+      lane_[3] = Round(lane_[3], Read64(p + 24));
+      p += 32;
+      size -= 32;
+    }
+    return size;
+  }
+
+public:
+  explicit FrameHash(uint64_t seed = 0) { reset(seed); }
+
+  void reset(uint64_t seed = 0)
+  {
+    seed_        = seed;
+    lane_[0]     = seed + Prime1 + Prime2;
+    lane_[1]     = seed + Prime2;
+    lane_[2]     = seed;
+    lane_[3]     = seed - Prime1;
+    pendingSize_ = 0;
+    total_       = 0;
+  }
+
+  void update(const void *data, size_t size)
+  {
+    auto *p = static_cast<const uint8_t *>(data);
+    total_ += size;
+    if (pendingSize_ + size < 32)
+    {
+      if (size > 0)
+      {
+        std::memcpy(pending_ + pendingSize_, p, size);
+      }
+      pendingSize_ += size;
+      return;
+    }
+    if (pendingSize_ > 0)
+    {
+      auto fill = 32 - pendingSize_;
+      std::memcpy(pending_ + pendingSize_, p, fill);
+      consume(pending_, 32);
+      p += fill;
+      size -= fill;
+      pendingSize_ = 0;
+    }
+    auto rest = consume(p, size);
+    std::memcpy(pending_, p + size - rest, rest);
+    pendingSize_ = rest;
+  }
+
+  // パディングを含む型は中身が同じでも値が変わることがある(一致しない側に倒れるだけ)
+  template <class T>
+  void add(const T &value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    update(&value, sizeof(T));
+  }
+
+  [[nodiscard]] uint64_t digest() const
+  {
+    uint64_t h;
+    if (total_ >= 32)
+    {
+      h = Rotl(lane_[0], 1) + Rotl(lane_[1], 7) + Rotl(lane_[2], 12) + Rotl(lane_[3], 18);
+      for (auto lane : lane_)
+      {
+        h = Merge(h, lane);
+      }
+    }
+    else
+    {
+      h = seed_ + Prime5;
+    }
+    h += total_;
+
+    const uint8_t *p   = pending_;
+    const uint8_t *end = pending_ + pendingSize_;
+    for (; p + 8 <= end; p += 8)
+    {
+      h ^= Round(0, Read64(p));
+      h = Rotl(h, 27) * Prime1 + Prime4;
+    }
+    if (p + 4 <= end)
+    {
+      h ^= uint64_t(Read32(p)) * Prime1;
+      h = Rotl(h, 23) * Prime2 + Prime3;
+      p += 4;
+    }
+    for (; p < end; p++)
+    {
+      h ^= uint64_t(*p) * Prime5;
+      h = Rotl(h, 11) * Prime1;
+    }
+
+    h ^= h >> 33;
+    h *= Prime2;
+    h ^= h >> 29;
+    h *= Prime3;
+    h ^= h >> 32;
+    return h;
+  }
+
+  // 一度に計算する
+  static uint64_t Compute(const void *data, size_t size, uint64_t seed = 0)
+  {
+    FrameHash hash{seed};
+    hash.update(data, size);
+    return hash.digest();
+  }
+};
@@ -0,0 +1,9 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "image_downsample.h"
+
+// 画像ファイルをストレートアルファのRGBA8(sRGB)にデコードする
+bool DecodeImageFile(const char *path, uint32_t rowAlignment, ImageDownsample::Image &image);
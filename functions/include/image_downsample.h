@@ -0,0 +1,34 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//
+// RGBA8画像のミップマップ生成(2x2ボックスフィルタ)
+//
+namespace ImageDownsample
+{
+
+struct Image
+{
+  uint32_t             width       = 0;
+  uint32_t             height      = 0;
+  uint32_t             bytesPerRow = 0;
+  std::vector<uint8_t> pixels;
+};
+
+uint32_t MipLevelCount(uint32_t width, uint32_t height);
+uint32_t RowBytes(uint32_t width, uint32_t alignment);
+
+// 1段縮小。色はアルファで重み付けして平均する(srgbならリニア空間で)
+void HalveRGBA8(const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight, uint32_t srcBytesPerRow,
+                uint8_t *dst, uint32_t dstBytesPerRow, bool srgb);
+
+// level 1以降を生成して返す
+std::vector<Image> BuildMipChain(const uint8_t *src, uint32_t width, uint32_t height,
+                                 uint32_t bytesPerRow, bool srgb, uint32_t rowAlignment = 4);
+
+} // namespace ImageDownsample
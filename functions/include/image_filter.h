@@ -0,0 +1,150 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+//
+// CPUで処理する画像フィルタ
+// ノードを直列につないだグラフで、ソースかパラメータが変わった段から後ろだけを再計算する
+//
+namespace ImageFilter
+{
+
+// RGBA(0..1)のfloat画像(sRGBのソースはリニアに戻したもの)
+struct ImageF
+{
+  uint32_t           width  = 0;
+  uint32_t           height = 0;
+  std::vector<float> pixels;
+
+  void resize(uint32_t w, uint32_t h)
+  {
+    width  = w;
+    height = h;
+    pixels.resize((size_t)w * h * 4);
+  }
+};
+
+//
+class Node
+{
+  uint64_t version_ = 1;
+
+protected:
+  void touch() { version_++; }
+
+public:
+  Node()          = default;
+  virtual ~Node() = default;
+
+  [[nodiscard]] uint64_t version() const { return version_; }
+
+  virtual void apply(const ImageF &src, ImageF &dst) const = 0;
+};
+using NodePtr = std::shared_ptr<Node>;
+
+// 4x5のカラーマトリクス(行: R,G,B,A 列: r,g,b,a,bias)
+class ColorMatrix : public Node
+{
+  float matrix_[20];
+
+public:
+  ColorMatrix();
+  void setMatrix(const float (&matrix)[20]);
+  void apply(const ImageF &src, ImageF &dst) const override;
+};
+
+//
+class BoxBlur : public Node
+{
+  int radius_;
+
+public:
+  explicit BoxBlur(int radius = 1) : radius_(radius) {}
+  void setRadius(int radius);
+  void apply(const ImageF &src, ImageF &dst) const override;
+};
+
+//
+class GaussianBlur : public Node
+{
+  float sigma_;
+
+public:
+  explicit GaussianBlur(float sigma = 1.0f) : sigma_(sigma) {}
+  void setSigma(float sigma);
+  void apply(const ImageF &src, ImageF &dst) const override;
+};
+
+// 輝度がlevel以上なら白、未満なら黒(アルファはそのまま)
+class Threshold : public Node
+{
+  float level_;
+
+public:
+  explicit Threshold(float level = 0.5f) : level_(level) {}
+  void setLevel(float level);
+  void apply(const ImageF &src, ImageF &dst) const override;
+};
+
+// 輝度に色を掛けたものとamountで混ぜる
+class Tint : public Node
+{
+  float color_[3];
+  float amount_;
+
+public:
+  Tint(float red = 1.0f, float green = 1.0f, float blue = 1.0f, float amount = 1.0f);
+  void setColor(float red, float green, float blue, float amount);
+  void apply(const ImageF &src, ImageF &dst) const override;
+};
+
+//
+//
+//
+class Graph
+{
+  ImageF                source_;
+  uint64_t              sourceVersion_ = 1;
+  uint64_t              builtSource_   = 0;
+  size_t                builtCount_    = 0; // outputを作った時の段数
+  std::vector<NodePtr>  nodes_;
+  std::vector<ImageF>   stages_;
+  std::vector<uint64_t> stamps_;
+  std::vector<uint8_t>  output_;
+  bool                  srgb_ = false;
+
+public:
+  Graph()  = default;
+  ~Graph() = default;
+
+  // RGBA8を入力にする
+  // srgbならRGBをリニアに戻してからフィルタを掛け、出力もsRGBに戻す(アルファはそのまま)
+  void setSource(const uint8_t *rgba, uint32_t width, uint32_t height, uint32_t bytesPerRow,
+                 bool srgb = false);
+
+  template <class T, class... Args>
+  std::shared_ptr<T> add(Args &&...args)
+  {
+    auto node = std::make_shared<T>(std::forward<Args>(args)...);
+    nodes_.push_back(node);
+    return node;
+  }
+  void clear();
+
+  [[nodiscard]] bool isDirty() const;
+  // 変更があった時だけ処理してtrueを返す
+  bool process();
+
+  [[nodiscard]] uint32_t       width() const { return source_.width; }
+  [[nodiscard]] uint32_t       height() const { return source_.height; }
+  [[nodiscard]] const uint8_t *output() const { return output_.data(); }
+  [[nodiscard]] uint32_t       outputBytesPerRow() const { return source_.width * 4; }
+};
+
+} // namespace ImageFilter
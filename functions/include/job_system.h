@@ -0,0 +1,188 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//
+// ワークスティーリング方式のジョブシステム
+// ワーカー毎にChase-Levの両端キューを持ち、自分のキューが空になったら他から盗む
+// ワーカー以外のスレッドから投入したジョブは共有キューを経由する
+//
+class JobSystem
+{
+  struct Job;
+
+public:
+  // 未完了のジョブ数(wait()はジョブを実行しながら0になるのを待つ)
+  class Counter
+  {
+    friend class JobSystem;
+    // 続きのジョブが登録されている間は立てておく(0にならないので破棄されない)
+    static constexpr size_t ContinuationFlag = size_t(1) << 62;
+
+    std::atomic<size_t> pending_{0};
+    Job                *continuation_ = nullptr;
+
+  public:
+    Counter()                           = default;
+    Counter(const Counter &)            = delete;
+    Counter &operator=(const Counter &) = delete;
+
+    [[nodiscard]] bool done() const { return pending_.load(std::memory_order_acquire) == 0; }
+  };
+
+  // まとめて待つジョブ(then()で全て終わった後に続けて実行するジョブを登録できる)
+  class TaskGroup
+  {
+    JobSystem &system_;
+    Counter    counter_;
+    bool       sealed_ = false;
+
+  public:
+    explicit TaskGroup(JobSystem &system);
+    ~TaskGroup();
+    TaskGroup(const TaskGroup &)            = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    void run(std::function<void()> func);
+    // これ以降run()は呼べない
+    void then(std::function<void()> func);
+    void wait();
+  };
+
+  struct Stats
+  {
+    size_t executed; // 実行したジョブ数
+    size_t stolen;   // 他のワーカーから盗んだ数
+    size_t inlined;  // キューが一杯で投入元が直接実行した数
+  };
+
+private:
+  struct Job
+  {
+    void (*entry)(Job &) = nullptr; // nullptrならfuncを呼ぶ
+    void                 *data  = nullptr;
+    size_t                begin = 0;
+    size_t                end   = 0;
+    std::function<void()> func;
+    Counter              *counter = nullptr;
+  };
+
+  // Chase-Lev(push/popは持ち主のスレッドのみ、stealはどのスレッドからでも)
+  class WorkQueue
+  {
+    static constexpr int64_t Capacity = 4096;
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::unique_ptr<std::atomic<Job *>[]> buffer_;
+
+  public:
+    WorkQueue();
+
+    bool               push(Job *job);
+    Job               *pop();
+    Job               *steal();
+    [[nodiscard]] bool empty() const;
+  };
+
+  // parallelFor用
+  struct RangeContext
+  {
+    JobSystem *system;
+    void (*call)(void *, size_t, size_t);
+    void   *func;
+    size_t  chunk;
+    Counter counter;
+  };
+
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  std::vector<std::thread>                threads_;
+  std::mutex                              injectMutex_;
+  std::deque<Job *>                       injected_;
+  std::atomic<size_t>                     injectedCount_{0};
+
+  // 待機
+  std::mutex              sleepMutex_;
+  std::condition_variable sleepCond_;
+  std::atomic<int64_t>    queued_{0};
+  std::atomic<int>        sleepers_{0};
+  std::atomic<bool>       stop_{false};
+
+  // 統計
+  std::atomic<size_t> executed_{0};
+  std::atomic<size_t> stolen_{0};
+  std::atomic<size_t> inlined_{0};
+  Stats               lastFrame_{};
+  Counter             frameCounter_;
+
+  static std::vector<Job *> &jobPool();
+  static Job                *allocateJob();
+  static void                releaseJob(Job *job);
+  static void                rangeEntry(Job &job);
+
+  void workerMain(size_t index);
+  void submit(Job *job);
+  void execute(Job *job);
+  void finish(Counter &counter);
+  void launchContinuation(Counter &counter);
+  Job *take();
+  bool localQueueEmpty();
+  void splitRange(RangeContext &ctx, size_t begin, size_t end);
+  void parallelForImpl(size_t count, size_t chunk, void (*call)(void *, size_t, size_t),
+                       void *func);
+
+public:
+  // workers: 0ならコア数-1(呼び出し元のスレッドも待つ間はジョブを実行する)
+  explicit JobSystem(size_t workers = 0);
+  ~JobSystem();
+  JobSystem(const JobSystem &)            = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  // 共有のインスタンス
+  static JobSystem &Default();
+
+  // ワーカー数+1
+  [[nodiscard]] size_t concurrency() const { return threads_.size() + 1; }
+
+  void run(Counter &counter, std::function<void()> func);
+  void wait(Counter &counter);
+
+  // [0, count)を分割して並列に処理する。func(begin, end)
+  // 手の空いたワーカーがいる間だけ残りの後半を切り出して渡す(最小grain)
+  template <class Func>
+  void parallelFor(size_t count, size_t grain, Func &&func)
+  {
+    using F      = std::remove_reference_t<Func>;
+    size_t chunk = std::max({grain, size_t{1}, count / (concurrency() * 8)});
+    if (count <= chunk || threads_.empty())
+    {
+      func(size_t{0}, count);
+      return;
+    }
+    parallelForImpl(
+        count,
+        chunk,
+        [](void *f, size_t begin, size_t end) { (*static_cast<F *>(f))(begin, end); },
+        const_cast<std::remove_const_t<F> *>(&func));
+  }
+
+  // フレーム単位のジョブ(endFrame()で全て終わるのを待つ)
+  void runFrame(std::function<void()> func) { run(frameCounter_, std::move(func)); }
+  void endFrame();
+  // 直前のフレームの統計
+  [[nodiscard]] Stats frameStats() const { return lastFrame_; }
+};
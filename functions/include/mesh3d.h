@@ -0,0 +1,28 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#import <Metal/Metal.h>
+#include <simd/vector_types.h>
+
+//
+// 3Dの三角形を記録しておき、モデル行列とカラーを変えて何度でも描画できるメッシュ
+// 頂点は最初の描画時にGPUバッファへまとめて転送する
+//
+@interface Mesh3D : NSObject
+
+@property(readonly) NSUInteger vertexCount;
+// vertexBufferを作り直す度に変わる(全てのメッシュで一意)
+@property(readonly) uint64_t revision;
+
+- (nonnull instancetype)initWithDevice:(nonnull id<MTLDevice>)device;
+- (void)clear;
+- (void)drawTriangle:(simd_float3)p0 p1:(simd_float3)p1 p2:(simd_float3)p2 color:(simd_float4)color;
+- (void)drawPlane:(simd_float3)p0
+               p1:(simd_float3)p1
+               p2:(simd_float3)p2
+               p3:(simd_float3)p3
+            color:(simd_float4)color;
+// 記録が変わった時だけ作り直す
+- (nullable id<MTLBuffer>)vertexBuffer;
+
+@end
@@ -0,0 +1,137 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <arm_neon.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <simd/simd.h>
+#include <vector>
+
+//
+// パーティクル(SoA配置)
+// 更新と頂点書き出しはコア数に合わせて分割して並列に処理する
+//
+namespace Particle
+{
+
+// GPUへ渡す1粒子分(shader_def.hのParticleDataと同じ配置)
+// 四角形への展開は頂点シェーダーで行う
+struct Vertex
+{
+  simd_float3 position;
+  float       size;
+  float16x4_t color;
+};
+
+// 発生源
+struct EmitterDesc
+{
+  simd_float3 position       = {0.0f, 0.0f, 0.0f};
+  simd_float3 positionSpread = {0.0f, 0.0f, 0.0f}; // ±の範囲で散らす
+  simd_float3 velocity       = {0.0f, 1.0f, 0.0f};
+  simd_float3 velocitySpread = {0.0f, 0.0f, 0.0f};
+  float       rate           = 0.0f; // 1秒あたりの発生数
+  float       lifeMin        = 1.0f; // 秒
+  float       lifeMax        = 1.0f;
+  float       sizeStart      = 1.0f;
+  float       sizeEnd        = 1.0f;
+};
+
+// 外力
+struct Forces
+{
+  simd_float3 gravity = {0.0f, 0.0f, 0.0f};
+  simd_float3 wind    = {0.0f, 0.0f, 0.0f}; // dragがあるとこの速度に近づく
+  float       drag    = 0.0f;               // 1秒あたりの減衰率
+};
+
+// 寿命に対する色の変化(キー間は線形補間)
+class ColorCurve
+{
+public:
+  static constexpr int TableSize = 64;
+
+private:
+  struct Key
+  {
+    float       time;
+    simd_float4 color;
+  };
+  std::vector<Key>                       keys_;
+  std::array<float16x4_t, TableSize + 1> table_;
+
+  void build();
+
+public:
+  ColorCurve();
+  explicit ColorCurve(simd_float4 color);
+  ColorCurve(simd_float4 start, simd_float4 end);
+
+  // time: 0(発生)..1(消滅)
+  void addKey(float time, simd_float4 color);
+  void clear();
+
+  [[nodiscard]] simd_float4 evaluate(float time) const;
+  [[nodiscard]] float16x4_t lookup(float time) const
+  {
+    int index = int(time * TableSize);
+    return table_[index < 0 ? 0 : (index > TableSize ? TableSize : index)];
+  }
+};
+
+//
+//
+//
+class System
+{
+  // SoA
+  std::vector<float> posX_, posY_, posZ_;
+  std::vector<float> velX_, velY_, velZ_;
+  std::vector<float> age_;
+  std::vector<float> invLife_;
+
+  size_t      count_     = 0;
+  size_t      capacity_  = 0;
+  float       emitCarry_ = 0.0f;
+  uint32_t    random_    = 0x9e3779b9;
+  EmitterDesc emitter_;
+  Forces      forces_;
+  ColorCurve  colorCurve_;
+
+  // 寿命が尽きたもの(チャンク毎)
+  std::vector<std::vector<uint32_t>> dead_;
+
+  float random01();
+  float randomSigned();
+
+public:
+  explicit System(size_t capacity);
+  ~System() = default;
+
+  void setEmitter(const EmitterDesc &desc) { emitter_ = desc; }
+  void setForces(const Forces &forces) { forces_ = forces; }
+  void setColorCurve(const ColorCurve &curve) { colorCurve_ = curve; }
+
+  [[nodiscard]] EmitterDesc      &emitter() { return emitter_; }
+  [[nodiscard]] Forces           &forces() { return forces_; }
+  [[nodiscard]] const ColorCurve &colorCurve() const { return colorCurve_; }
+
+  // 一度に発生させる(容量を超えた分は捨てる)
+  void emit(size_t count);
+  // 発生(rate)、積分、寿命の処理
+  void update(float dt);
+  void clear();
+
+  [[nodiscard]] size_t size() const { return count_; }
+  [[nodiscard]] size_t capacity() const { return capacity_; }
+
+  // [begin, end)をdstへ書き出す。scaleは座標と大きさに掛ける
+  void write(Vertex *dst, size_t begin, size_t end, float scale = 1.0f) const;
+  // 全体を並列で書き出す
+  void writeAll(Vertex *dst, float scale = 1.0f) const;
+};
+
+} // namespace Particle
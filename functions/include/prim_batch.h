@@ -0,0 +1,41 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <simd/vector_types.h>
+
+//
+// まとめて描画するためのプリミティブ
+// 1回の呼び出しで頂点領域を確保し、まとめて書き込む
+//
+
+// 2D(ポイント単位)
+struct Line2D
+{
+  simd_float2 from;
+  simd_float2 to;
+  simd_float4 color;
+};
+
+struct Rect2D
+{
+  simd_float2 from;
+  simd_float2 to;
+  simd_float4 color;
+};
+
+// 3D
+struct Line3D
+{
+  simd_float3 from;
+  simd_float3 to;
+  simd_float4 color;
+};
+
+struct Triangle3D
+{
+  simd_float3 p0;
+  simd_float3 p1;
+  simd_float3 p2;
+};
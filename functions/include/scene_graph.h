@@ -0,0 +1,94 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <simd/simd.h>
+#include <span>
+#include <vector>
+
+//
+// 親子関係を持つ変換の階層
+// ノードは深さ順に並べた配列(SoA)で持ち、update()では変更のあった部分木だけを
+// 深さ毎にまとめて(大きければ並列に)計算する。何も変更がなければ何もしない
+// 書き込みはスレッドセーフではない
+//
+namespace Scene
+{
+
+using NodeId                 = uint32_t;
+constexpr NodeId InvalidNode = 0xffffffff;
+
+// 拡大縮小→回転→平行移動の順に適用する
+struct Transform
+{
+  simd_float3 position = {0.0f, 0.0f, 0.0f};
+  simd_quatf  rotation = simd_quaternion(0.0f, 0.0f, 0.0f, 1.0f);
+  simd_float3 scale    = {1.0f, 1.0f, 1.0f};
+};
+
+//
+//
+//
+class Graph
+{
+  // 以下は深さ順(親は必ず子より前)
+  std::vector<NodeId>        ids_;
+  std::vector<uint32_t>      parent_; // 配列上の位置
+  std::vector<uint32_t>      depth_;
+  std::vector<Transform>     local_;
+  std::vector<simd_float4x4> world_;
+  std::vector<uint8_t>       dirty_;   // ローカルの変更
+  std::vector<uint32_t>      changed_; // ワールドを計算し直したupdate()の番号
+  std::vector<uint32_t>      levelStart_;
+
+  // NodeId -> 配列上の位置
+  std::vector<uint32_t> indexOf_;
+  std::vector<NodeId>   freeIds_;
+
+  uint32_t serial_        = 0;
+  uint32_t minDirtyDepth_ = UINT32_MAX;
+  uint32_t maxDirtyDepth_ = 0;
+  bool     orderDirty_    = false;
+
+  void     markDirty(uint32_t index);
+  void     rebuildOrder();
+  void     rebuildLevels();
+  bool     updateRange(size_t begin, size_t end);
+  uint32_t depthOf(uint32_t index) const;
+
+public:
+  Graph()  = default;
+  ~Graph() = default;
+
+  // parentがInvalidNodeならルート
+  NodeId create(NodeId parent = InvalidNode, const Transform &local = {});
+  // 子孫も全て破棄する(破棄したNodeIdは再利用される)
+  void   destroy(NodeId id);
+  // 自分の子孫は親にできない(失敗したらfalse)
+  bool   setParent(NodeId id, NodeId parent);
+  void   clear();
+
+  [[nodiscard]] bool   contains(NodeId id) const;
+  [[nodiscard]] NodeId parent(NodeId id) const;
+  [[nodiscard]] size_t size() const { return ids_.size(); }
+
+  // ローカルの変換
+  void setLocal(NodeId id, const Transform &local);
+  void setPosition(NodeId id, simd_float3 position);
+  void setRotation(NodeId id, simd_quatf rotation);
+  void setScale(NodeId id, simd_float3 scale);
+  [[nodiscard]] const Transform &local(NodeId id) const { return local_[indexOf_[id]]; }
+
+  // 変更のあった部分木のワールド行列を計算し直す
+  void update();
+  // update()後の値
+  [[nodiscard]] const simd_float4x4 &world(NodeId id) const { return world_[indexOf_[id]]; }
+  // 深さ順に並んだ全ノード(ids()と同じ並び)
+  [[nodiscard]] std::span<const simd_float4x4> worldMatrices() const { return world_; }
+  [[nodiscard]] std::span<const NodeId>        ids() const { return ids_; }
+};
+
+} // namespace Scene
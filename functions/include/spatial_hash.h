@@ -0,0 +1,79 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <simd/simd.h>
+#include <utility>
+#include <vector>
+
+//
+// 四角形(回転したスプライトなど)の一様グリッドによる索引
+// セルはハッシュでバケットに割り当てるので、座標の範囲に制限はない
+// 要素は四角形が覆うセル全てに登録し、セルが変わらない更新ではバケットに触らない
+// 問い合わせは近くにある要素の数にだけ比例する。スレッドセーフではない
+//
+class SpatialHash2D
+{
+public:
+  using Handle                     = uint32_t;
+  static constexpr Handle NoHandle = 0;
+
+private:
+  struct Item
+  {
+    simd_float2 quad[4]; // 凸多角形の順(0,1,2,3)
+    simd_float2 lo;
+    simd_float2 hi;
+    int32_t     cell[4]; // 覆うセルの範囲(x0, y0, x1, y1)
+    uint64_t    order;
+    uint32_t    frame;
+    Handle      handle;
+    bool        large; // セルが多すぎるものはlarge_で別に持つ
+  };
+
+  float                            invCellSize_;
+  std::vector<std::vector<Handle>> buckets_;
+  std::vector<Item>                items_;
+  std::vector<uint32_t>            slotOf_; // Handle -> items_の位置
+  std::vector<Handle>              large_;
+  std::vector<uint32_t>            mark_; // 問い合わせ中に見たもの(items_と同じ並び)
+  uint32_t                         markStamp_ = 0;
+  uint32_t                         frame_     = 0;
+
+  [[nodiscard]] size_t bucketOf(int32_t x, int32_t y) const;
+  void                 cellRange(const Item &item, int32_t *cell) const;
+  void                 link(const Item &item);
+  void                 unlink(const Item &item);
+  uint32_t             nextMark();
+  void                 sortByOrder(std::vector<Handle> &out, size_t start) const;
+  template <class Func>
+  void forEachNear(simd_float2 lo, simd_float2 hi, Func &&func);
+
+public:
+  // cellSize: よく問い合わせる範囲や要素の大きさくらいにする
+  explicit SpatialHash2D(float cellSize = 128.0f, size_t bucketCount = 4096);
+  ~SpatialHash2D() = default;
+
+  // cornersはトライアングルストリップ順(Sprite updateの結果)
+  // orderは手前にあるものほど大きい値(問い合わせの結果はこの降順)
+  void update(Handle handle, const simd_float2 *corners, uint64_t order = 0);
+  void remove(Handle handle);
+  void clear();
+  // 以降update()しなかったものをsweep()でまとめて取り除く
+  void beginFrame() { frame_++; }
+  void sweep();
+
+  [[nodiscard]] bool   contains(Handle handle) const;
+  [[nodiscard]] size_t size() const { return items_.size(); }
+
+  // 結果はoutの後ろに追加する
+  void queryPoint(simd_float2 point, std::vector<Handle> &out);
+  void queryRect(simd_float2 from, simd_float2 to, std::vector<Handle> &out);
+  // handleと重なるもの(自分は含まない)
+  void queryOverlaps(Handle handle, std::vector<Handle> &out);
+  // 重なっている組み合わせ全て(各組は1回だけ)
+  void queryPairs(std::vector<std::pair<Handle, Handle>> &out);
+};
@@ -3,9 +3,17 @@
 //
 #import <CoreImage/CoreImage.h>
 #import <MetalKit/MetalKit.h>
+#include <memory>
 #include <simd/vector_types.h>
 #include <vector>
 
+namespace ImageFilter
+{
+class Graph;
+}
+
+@class TextureCache;
+
 using SprPosList = std::vector<simd_float2>;
 
 @interface Sprite : NSObject
@@ -28,13 +36,24 @@ typedef NS_ENUM(NSUInteger, SpriteAlign) {
 @property float                              scale;
 @property SpriteAlign                        align;
 @property simd_float2                        position;
+// 当たり判定(SpatialHash2D)で使う番号(0は使わない)。破棄すると他のスプライトが再利用する
+@property(readonly) uint32_t handle;
 
 - (nonnull instancetype)initWithTexture:(nullable id<MTLTexture>)texture;
+- (nonnull instancetype)initWithTexture:(nullable id<MTLTexture>)texture
+                                  cache:(nullable TextureCache *)cache;
 - (nonnull instancetype)initWithImage:(nonnull CIImage *)image
                               texture:(nullable id<MTLTexture>)texture;
+- (nonnull instancetype)initWithImage:(nonnull CIImage *)image
+                              texture:(nullable id<MTLTexture>)texture
+                                cache:(nullable TextureCache *)cache;
 - (nonnull CIFilter *)setFilter:(nonnull NSString *)name override:(BOOL)ovrd;
 - (void)setFilter:(nonnull CIFilter *)filter;
 - (void)renderImage:(nullable id<MTLCommandBuffer>)cmdBuff;
+// CPUフィルタ(グラフはスプライト毎に用意する)
+- (void)setImageFilter:(std::shared_ptr<ImageFilter::Graph>)graph;
+// テクスチャを書き換えたらYES
+- (BOOL)applyImageFilter;
 - (const SprPosList &)update;
 
 @end
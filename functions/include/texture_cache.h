@@ -0,0 +1,42 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#import <MetalKit/MetalKit.h>
+
+// キャッシュ統計
+typedef struct
+{
+  NSUInteger textureCount;   // 管理中のテクスチャ数
+  NSUInteger bytesInUse;     // 参照中のテクスチャ
+  NSUInteger bytesCached;    // 未参照(破棄候補)のテクスチャ
+  NSUInteger bytesTransient; // 文字列などフレーム単位のテクスチャ
+  NSUInteger budget;
+  NSUInteger hits;      // 直前フレームの値
+  NSUInteger misses;    // 直前フレームの値
+  NSUInteger evictions; // 直前フレームの値
+} TextureCacheStats;
+
+//
+// パス+パラメータをキーにテクスチャを共有し、参照カウントで管理する
+// 未参照のテクスチャは予算を超えた時に古いものから破棄する
+//
+@interface TextureCache : NSObject
+
+@property NSUInteger budget;
+
+- (nonnull instancetype)initWithDevice:(nonnull id<MTLDevice>)device;
+
+// 参照カウント+1(共有)
+- (nullable id<MTLTexture>)textureWithFile:(nonnull NSString *)fname;
+// 参照カウント+1(非共有: フィルタ出力先など)
+- (nullable id<MTLTexture>)uniqueTextureWithDescriptor:(nonnull MTLTextureDescriptor *)desc;
+// 参照カウント-1
+- (void)releaseTexture:(nullable id<MTLTexture>)texture;
+
+- (void)addTransientBytes:(NSUInteger)bytes;
+- (void)removeTransientBytes:(NSUInteger)bytes;
+
+- (TextureCacheStats)stats;
+- (void)endFrame;
+
+@end
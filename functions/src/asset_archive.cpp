@@ -0,0 +1,160 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "asset_archive.h"
+#include "image_downsample.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace AssetArchive
+{
+namespace
+{
+
+// levelの先頭までのバイト数(width/heightはそのレベルの大きさ)
+uint64_t LevelOffset(const ArchiveEntry &entry, uint32_t level, uint32_t &width, uint32_t &height)
+{
+  // ミップレベルは大きい順に連続して格納されている
+  uint64_t offset = 0;
+  width           = entry.width;
+  height          = entry.height;
+  for (uint32_t i = 0; i < level; i++)
+  {
+    offset += (uint64_t)AlignedRowBytes(width) * height;
+    width  = std::max(width / 2, 1u);
+    height = std::max(height / 2, 1u);
+  }
+  return offset;
+}
+
+} // namespace
+
+//
+Reader::~Reader() { close(); }
+
+//
+bool Reader::open(const char *path)
+{
+  close();
+
+  fd_ = ::open(path, O_RDONLY);
+  if (fd_ < 0)
+  {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd_, &st) != 0 || st.st_size <= 0)
+  {
+    close();
+    return false;
+  }
+
+  auto *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (mapped == MAP_FAILED)
+  {
+    close();
+    return false;
+  }
+  base_ = static_cast<const uint8_t *>(mapped);
+  size_ = st.st_size;
+  if (size_ < sizeof(ArchiveHeader))
+  {
+    close();
+    return false;
+  }
+
+  // オフセットは加算で溢れないように残りサイズと比べる
+  auto *header    = reinterpret_cast<const ArchiveHeader *>(base_);
+  auto  tableSize = (uint64_t)header->tableSize * sizeof(ArchiveEntry);
+  if (header->magic != Magic || header->version != Version || header->tableOffset > size_ ||
+      tableSize > size_ - header->tableOffset || header->tableOffset % alignof(ArchiveEntry) != 0 ||
+      header->stringOffset > size_ || (header->tableSize & (header->tableSize - 1)) != 0)
+  {
+    close();
+    return false;
+  }
+  header_ = header;
+  table_  = reinterpret_cast<const ArchiveEntry *>(base_ + header->tableOffset);
+  return true;
+}
+
+//
+void Reader::close()
+{
+  if (base_ != nullptr)
+  {
+    munmap(const_cast<uint8_t *>(base_), size_);
+  }
+  if (fd_ >= 0)
+  {
+    ::close(fd_);
+  }
+  fd_     = -1;
+  base_   = nullptr;
+  size_   = 0;
+  header_ = nullptr;
+  table_  = nullptr;
+}
+
+//
+const ArchiveEntry *Reader::find(std::string_view name) const
+{
+  if (header_ == nullptr || header_->tableSize == 0)
+  {
+    return nullptr;
+  }
+
+  auto hash = HashName(name);
+  auto mask = header_->tableSize - 1;
+  for (uint32_t i = 0; i < header_->tableSize; i++)
+  {
+    const auto &entry = table_[(hash + i) & mask];
+    if (entry.hash == 0)
+    {
+      return nullptr;
+    }
+    if (entry.hash == hash && entry.nameLength == name.size() &&
+        (uint64_t)entry.nameOffset + entry.nameLength <= size_ - header_->stringOffset)
+    {
+      auto *str = reinterpret_cast<const char *>(base_ + header_->stringOffset + entry.nameOffset);
+      if (std::string_view{str, entry.nameLength} == name)
+      {
+        return isValid(entry) ? &entry : nullptr;
+      }
+    }
+  }
+  return nullptr;
+}
+
+// 壊れた(切り詰められた)アーカイブのエントリを弾く
+bool Reader::isValid(const ArchiveEntry &entry) const
+{
+  if (entry.width == 0 || entry.height == 0 || entry.mipLevels == 0 ||
+      entry.mipLevels > ImageDownsample::MipLevelCount(entry.width, entry.height) ||
+      entry.dataOffset > size_ || entry.dataSize > size_ - entry.dataOffset)
+  {
+    return false;
+  }
+  uint32_t width, height;
+  auto     total = LevelOffset(entry, entry.mipLevels, width, height);
+  return total <= entry.dataSize;
+}
+
+//
+ImageLevel Reader::getLevel(const ArchiveEntry &entry, uint32_t level) const
+{
+  // 範囲外ならdataはnullptr
+  if (level >= entry.mipLevels || !isValid(entry))
+  {
+    return {nullptr, 0, 0, 0};
+  }
+  uint32_t width, height;
+  auto     offset = LevelOffset(entry, level, width, height);
+  return {base_ + entry.dataOffset + offset, width, height, AlignedRowBytes(width)};
+}
+
+} // namespace AssetArchive
@@ -2,6 +2,7 @@
 // Copyright 2024 Y.Suzuki(wave.suzuki.z@gmail.com)
 //
 #include "camera.h"
+#include <algorithm>
 #include <arm_neon.h>
 #include <complex>
 #include <simd/matrix.h>
@@ -17,6 +18,10 @@ CameraData::CameraData()
   upDir_      = simd_make_float3(0.0f, 1.0f, 0.0f);
   aspect_     = 1.0f;
   fovy_       = 45.0f;
+  znear_      = 0.1f;
+  zfar_       = 1000.0f;
+
+  viewProjectionDirty_ = true;
 }
 
 //
@@ -37,6 +42,7 @@ void CameraData::buildPerspective(float fovy, float aspect, float znear, float z
                                       simd_make_float4(0.0f, ys, 0.0f, 0.0f),
                                       simd_make_float4(0.0f, 0.0f, zs, zs2),
                                       simd_make_float4(0.0f, 0.0f, -1.0f, 0.0f));
+  viewProjectionDirty_ = true;
 }
 
 //
@@ -62,6 +68,86 @@ void CameraData::buildModelView(simd_float3 eye, simd_float3 look, simd_float3 u
   auto trans            = simd_make_float4(-eyePos[0], -eyePos[1], -eyePos[2], 1.0f);
   viewMtx.columns[3]    = simd_mul(viewMtx, trans);
   viewMtx.columns[3][3] = 1.0f;
+  viewProjectionDirty_  = true;
+}
+
+//
+const matrix_float4x4 &CameraData::getViewProjectionMatrix() const
+{
+  if (viewProjectionDirty_)
+  {
+    viewProjection_      = simd_mul(projection_, modelview_);
+    viewProjectionDirty_ = false;
+  }
+  return viewProjection_;
 }
 
 //
+simd_float3 CameraData::getViewRight() const
+{
+  const auto &m = modelview_;
+  return simd_make_float3(m.columns[0][0], m.columns[1][0], m.columns[2][0]);
+}
+
+//
+simd_float3 CameraData::getViewUp() const
+{
+  const auto &m = modelview_;
+  return simd_make_float3(m.columns[0][1], m.columns[1][1], m.columns[2][1]);
+}
+
+// 4点ずつ各成分を並べて計算する(1点ずつの行列積よりも乗算が少なく、除算もまとめられる)
+size_t CameraData::projectToScreen(std::span<const simd_float3> points, simd_float2 screenSize,
+                                   std::span<simd_float2> screen, std::span<uint8_t> visible) const
+{
+  // 画面の大きさまで畳み込んだ x, y, w の行(除算だけで画面の座標になる)
+  //   sx = (ndc.x + 1) * width / 2  = (x + w) * width / 2 / w
+  //   sy = (1 - ndc.y) * height / 2 = (w - y) * height / 2 / w
+  const auto &vp   = getViewProjectionMatrix();
+  auto        half = screenSize * 0.5f;
+  simd_float4 rowX;
+  simd_float4 rowY;
+  simd_float4 rowW;
+  for (int c = 0; c < 4; c++)
+  {
+    const auto &col = vp.columns[c];
+    rowX[c]         = (col[0] + col[3]) * half[0];
+    rowY[c]         = (col[3] - col[1]) * half[1];
+    rowW[c]         = col[3];
+  }
+
+  size_t count     = std::min({points.size(), screen.size(), visible.size()});
+  size_t nbVisible = 0;
+  size_t i         = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    const auto *p  = points.data() + i;
+    auto        px = simd_make_float4(p[0].x, p[1].x, p[2].x, p[3].x);
+    auto        py = simd_make_float4(p[0].y, p[1].y, p[2].y, p[3].y);
+    auto        pz = simd_make_float4(p[0].z, p[1].z, p[2].z, p[3].z);
+    auto        sx = rowX[0] * px + rowX[1] * py + rowX[2] * pz + rowX[3];
+    auto        sy = rowY[0] * px + rowY[1] * py + rowY[2] * pz + rowY[3];
+    auto        w  = rowW[0] * px + rowW[1] * py + rowW[2] * pz + rowW[3];
+    auto        rw = 1.0f / w;
+    sx *= rw;
+    sy *= rw;
+    for (int k = 0; k < 4; k++)
+    {
+      // wはビュー空間の奥行き
+      uint8_t front  = w[k] >= znear_;
+      screen[i + k]  = simd_make_float2(sx[k], sy[k]);
+      visible[i + k] = front;
+      nbVisible += front;
+    }
+  }
+  for (; i < count; i++)
+  {
+    auto    pos   = simd_make_float4(points[i], 1.0f);
+    float   w     = simd_dot(rowW, pos);
+    uint8_t front = w >= znear_;
+    screen[i]     = simd_make_float2(simd_dot(rowX, pos), simd_dot(rowY, pos)) / w;
+    visible[i]    = front;
+    nbVisible += front;
+  }
+  return nbVisible;
+}
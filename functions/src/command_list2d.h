@@ -0,0 +1,291 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "frame_hash.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <simd/simd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//
+// Draw2Dの描画コマンドの記録(ソートキーの計算と直前のコマンドへの結合)
+// Metalに依存しないので、バッファとテクスチャの型は呼び出し側が決める
+// ロックは呼び出し側で取る
+//
+
+constexpr uint32_t NoInstance    = ~0u;
+constexpr uint32_t NoClip        = 0; // 画面全体
+constexpr uint32_t MaxGeneration = 0xfff;
+constexpr size_t   MaxSortBounds = 32; // 1世代で範囲を覚えておくテクスチャの数
+
+// 同一レイヤー内ではこの順で描画される
+enum Pipeline2D : uint32_t
+{
+  PipelineFill,
+  PipelineListFill,
+  PipelineLine,
+  PipelineListLine,
+  PipelineParticle,
+  PipelineSprite,
+  PipelineText,
+  PipelineCount,
+};
+
+// 描画コマンド
+// キー: レイヤー(16) | パイプライン(4) | 世代(12) | テクスチャ(12) | 登録順(20)
+// 同じ世代の中は別のテクスチャ同士が重ならないので、テクスチャ毎にまとめて描いても見た目は変わらない
+template <class Buffer, class Texture>
+struct DrawCommand2D
+{
+  uint64_t   key_;
+  Pipeline2D pipeline_;
+  uint32_t   layer_;
+  uint32_t   vertexStart_;
+  uint32_t   vertexCount_;
+  uint32_t   instance_; // DisplayListの変換(NoInstanceなら無し)
+  uint32_t   clip_;     // クリップ矩形の番号(NoClipなら画面全体)
+  Buffer     buffer_;
+  Texture    texture_;
+};
+
+inline uint64_t MakeSortKey(uint32_t layer, Pipeline2D pipeline, uint32_t generation,
+                            uint32_t texture, uint32_t seq)
+{
+  // 世代を使い切ったら後は登録順に描く
+  if (generation >= MaxGeneration)
+  {
+    generation = MaxGeneration;
+    texture    = 0;
+  }
+  return ((uint64_t)layer << 48) | ((uint64_t)pipeline << 44) | ((uint64_t)generation << 32) |
+         ((uint64_t)(texture & 0xfff) << 20) | (seq & 0xfffff);
+}
+
+// 登録順を除いた部分が同じなら同じ順番で描かれる
+inline bool SameSortGroup(uint64_t key0, uint64_t key1) { return (key0 >> 20) == (key1 >> 20); }
+
+// クリップ矩形(ピクセル単位)
+struct ClipRect2D
+{
+  simd_float2 min;
+  simd_float2 max;
+};
+
+// パイプライン毎の今の世代と、その中で各テクスチャが描いた範囲
+struct SortGroup2D
+{
+  uint32_t                                     layer      = 0;
+  uint32_t                                     generation = 0;
+  std::vector<std::pair<uint32_t, ClipRect2D>> bounds;
+};
+
+inline bool IsEmpty(const ClipRect2D &clip)
+{
+  return clip.min.x >= clip.max.x || clip.min.y >= clip.max.y;
+}
+
+// 矩形(lo-hi)が少しでもクリップ矩形の内側にあるか(面積の無いクリップには何も入らない)
+inline bool Overlaps(const ClipRect2D &clip, simd_float2 lo, simd_float2 hi)
+{
+  return !IsEmpty(clip) && lo.x < clip.max.x && hi.x > clip.min.x && lo.y < clip.max.y &&
+         hi.y > clip.min.y;
+}
+
+// 面積のある重なりがあるか
+inline bool Intersects(const ClipRect2D &a, const ClipRect2D &b)
+{
+  return a.min.x < b.max.x && b.min.x < a.max.x && a.min.y < b.max.y && b.min.y < a.max.y;
+}
+
+// 点群を囲む矩形
+inline ClipRect2D Bounds(const simd_float2 *points, size_t count)
+{
+  ClipRect2D rect{points[0], points[0]};
+  for (size_t i = 1; i < count; i++)
+  {
+    rect.min = simd_min(rect.min, points[i]);
+    rect.max = simd_max(rect.max, points[i]);
+  }
+  return rect;
+}
+
+//
+template <class Buffer, class Texture>
+class CommandList2D
+{
+public:
+  using Command    = DrawCommand2D<Buffer, Texture>;
+  using TextureIds = std::pmr::unordered_map<const void *, uint32_t>;
+
+  static constexpr uint32_t NoSpace = ~0u;
+
+private:
+  std::vector<Command> commands_;
+  SortGroup2D          sortGroups_[PipelineCount];
+  TextureIds          *textureIds_ = nullptr;
+
+public:
+  std::vector<Command>       &commands() { return commands_; }
+  const std::vector<Command> &commands() const { return commands_; }
+
+  // フレームの始めに呼ぶ(idsはフレームアリーナ上に置いたもの)
+  void reset(TextureIds *ids)
+  {
+    commands_.clear();
+    for (auto &group : sortGroups_)
+    {
+      group.layer      = 0;
+      group.generation = 0;
+      group.bounds.clear();
+    }
+    textureIds_ = ids;
+  }
+
+  // ソートキー用のテクスチャ(バッファ)番号(フレーム内で初出順に振る)
+  uint32_t stateId(const void *object)
+  {
+    if (object == nullptr)
+    {
+      return 0;
+    }
+    auto [it, inserted] = textureIds_->try_emplace(object, (uint32_t)textureIds_->size() + 1);
+    return it->second;
+  }
+
+  // ソートキーを作る
+  // boundsがnullptrなら画面全体に描くものとして扱う
+  uint64_t sortKey(uint32_t layer, Pipeline2D pipeline, uint32_t texId, const ClipRect2D *bounds)
+  {
+    auto rect = bounds != nullptr ? *bounds
+                                  : ClipRect2D{simd_make_float2(-INFINITY, -INFINITY),
+                                               simd_make_float2(INFINITY, INFINITY)};
+
+    // 別のテクスチャが描いた範囲と重なったら世代を進める
+    auto &group = sortGroups_[pipeline];
+    bool  next  = group.layer != layer || group.bounds.size() >= MaxSortBounds;
+    for (size_t i = 0; i < group.bounds.size() && !next; i++)
+    {
+      next = group.bounds[i].first != texId && Intersects(group.bounds[i].second, rect);
+    }
+    if (next)
+    {
+      group.layer = layer;
+      group.generation++;
+      group.bounds.clear();
+    }
+
+    auto it = std::find_if(group.bounds.begin(),
+                           group.bounds.end(),
+                           [&](const auto &bound) { return bound.first == texId; });
+    if (it == group.bounds.end())
+    {
+      group.bounds.emplace_back(texId, rect);
+    }
+    else
+    {
+      it->second.min = simd_min(it->second.min, rect.min);
+      it->second.max = simd_max(it->second.max, rect.max);
+    }
+    return MakeSortKey(layer, pipeline, group.generation, texId, (uint32_t)commands_.size());
+  }
+
+  // bufferの頂点をcount個確保してコマンドを積み、先頭の番号を返す(足りなければNoSpace)
+  // 直前のコマンドと同じ順番で連続していれば結合する
+  uint32_t reserve(size_t count, Pipeline2D pipeline, uint32_t layer, uint32_t clip,
+                   Buffer buffer, Texture texture, size_t &counter, size_t capacity,
+                   const ClipRect2D *bounds)
+  {
+    if (counter + count > capacity)
+    {
+      return NoSpace;
+    }
+    auto start = (uint32_t)counter;
+    counter += count;
+
+    auto key = sortKey(layer, pipeline, stateId((const void *)texture), bounds);
+    if (!commands_.empty())
+    {
+      auto &last = commands_.back();
+      if (SameSortGroup(last.key_, key) && last.texture_ == texture && last.clip_ == clip &&
+          last.buffer_ == buffer && last.vertexStart_ + last.vertexCount_ == start)
+      {
+        last.vertexCount_ += count;
+        return start;
+      }
+    }
+
+    Command cmd;
+    cmd.key_         = key;
+    cmd.pipeline_    = pipeline;
+    cmd.layer_       = layer;
+    cmd.vertexStart_ = start;
+    cmd.vertexCount_ = (uint32_t)count;
+    cmd.instance_    = NoInstance;
+    cmd.clip_        = clip;
+    cmd.buffer_      = buffer;
+    cmd.texture_     = texture;
+    commands_.push_back(cmd);
+    return start;
+  }
+
+  // 記録したコマンドを描画内容のハッシュに加える
+  // 頂点バッファはページ毎に替わるので含めない(中身と数は呼び出し側で加える)
+  void addHash(FrameHash &hash) const
+  {
+    struct CommandState
+    {
+      uint32_t    pipeline;
+      uint32_t    layer;
+      uint32_t    vertexStart;
+      uint32_t    vertexCount;
+      uint32_t    instance;
+      uint32_t    clip;
+      const void *texture; // 文字列は毎フレーム作り直すので含めない
+    };
+    for (const auto &cmd : commands_)
+    {
+      CommandState state{cmd.pipeline_,
+                         cmd.layer_,
+                         cmd.vertexStart_,
+                         cmd.vertexCount_,
+                         cmd.instance_,
+                         cmd.clip_,
+                         cmd.pipeline_ == PipelineText ? nullptr : (const void *)cmd.texture_};
+      hash.add(state);
+    }
+  }
+
+  // reserveで確保したうち、endから後ろのunused個を返す
+  // 後から別の確保があって返せなければfalse(呼び出し側で描かれない頂点を書いておく)
+  bool shrink(Buffer buffer, size_t &counter, size_t end, size_t unused)
+  {
+    if (unused == 0)
+    {
+      return true;
+    }
+    if (commands_.empty() || counter != end + unused)
+    {
+      return false;
+    }
+    auto &last = commands_.back();
+    if (last.buffer_ != buffer || last.vertexStart_ + last.vertexCount_ != counter ||
+        last.vertexCount_ < unused)
+    {
+      return false;
+    }
+    counter -= unused;
+    last.vertexCount_ -= (uint32_t)unused;
+    if (last.vertexCount_ == 0)
+    {
+      commands_.pop_back();
+    }
+    return true;
+  }
+};
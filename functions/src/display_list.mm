@@ -0,0 +1,193 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#import "display_list.h"
+#include "prim2d_geometry.h"
+#include "shader_def.h"
+#include <arm_neon.h>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+// バッファを作り直す度に振る(全てのリストで一意)
+std::atomic<uint64_t> NextRevision{1};
+} // namespace
+
+@implementation DisplayList2D
+{
+  id<MTLDevice>                 device_;
+  id<MTLBuffer>                 buffer_;
+  std::vector<VertexDataPrim2D> fills_;
+  std::vector<VertexDataPrim2D> lines_;
+  simd_float4                   bounds_;
+  uint64_t                      revision_;
+  BOOL                          dirty_;
+  BOOL                          boundsDirty_;
+}
+
+//
+- (nonnull instancetype)initWithDevice:(nonnull id<MTLDevice>)device
+{
+  self = [super init];
+  if (self != nil)
+  {
+    device_ = [device retain];
+    buffer_      = nil;
+    bounds_      = simd_make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+    revision_    = 0;
+    dirty_       = NO;
+    boundsDirty_ = NO;
+  }
+  return self;
+}
+
+//
+- (void)dealloc
+{
+  [buffer_ release];
+  [device_ release];
+  [super dealloc];
+}
+
+- (NSUInteger)fillVertexCount
+{
+  return fills_.size();
+}
+
+- (NSUInteger)lineVertexCount
+{
+  return lines_.size();
+}
+
+- (uint64_t)revision
+{
+  return revision_;
+}
+
+//
+- (void)clear
+{
+  fills_.clear();
+  lines_.clear();
+  dirty_       = YES;
+  boundsDirty_ = YES;
+}
+
+//
+- (simd_float4)bounds
+{
+  if (boundsDirty_)
+  {
+    boundsDirty_ = NO;
+    if (fills_.empty() && lines_.empty())
+    {
+      bounds_ = simd_make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+      return bounds_;
+    }
+    auto lo = simd_make_float2(INFINITY, INFINITY);
+    auto hi = -lo;
+    for (const auto *list : {&fills_, &lines_})
+    {
+      for (const auto &vtx : *list)
+      {
+        lo = simd_min(lo, vtx.position);
+        hi = simd_max(hi, vtx.position);
+      }
+    }
+    bounds_ = simd_make_float4(lo, hi);
+  }
+  return bounds_;
+}
+
+// 末尾に頂点領域を追加する
+- (VertexDataPrim2D *)append:(size_t)count to:(std::vector<VertexDataPrim2D> &)list
+{
+  dirty_       = YES;
+  boundsDirty_ = YES;
+  auto start   = list.size();
+  list.resize(start + count);
+  return list.data() + start;
+}
+
+- (void)drawLine:(simd_float2)from to:(simd_float2)to color:(simd_float4)color
+{
+  Prim2D::WriteLine(
+      [self append:Prim2D::LineVertices to:lines_], from, to, vcvt_f16_f32(color));
+}
+
+- (void)drawRect:(simd_float2)from to:(simd_float2)to color:(simd_float4)color
+{
+  Prim2D::WriteRectLines(
+      [self append:Prim2D::RectLineVertices to:lines_], from, to, vcvt_f16_f32(color));
+}
+
+- (void)drawPolygon:(simd_float2)pos
+             radius:(float)rad
+             rotate:(float)rot
+           numSides:(int)sides
+              color:(simd_float4)color
+{
+  if (sides < 3)
+  {
+    return;
+  }
+  Prim2D::WritePolygonLines([self append:Prim2D::PolygonLineVertices(sides) to:lines_],
+                            pos,
+                            rad,
+                            rot,
+                            sides,
+                            vcvt_f16_f32(color));
+}
+
+- (void)fillRect:(simd_float2)from to:(simd_float2)to color:(simd_float4)color
+{
+  Prim2D::WriteRectFill(
+      [self append:Prim2D::RectFillVertices to:fills_], from, to, vcvt_f16_f32(color));
+}
+
+- (void)fillPolygon:(simd_float2)pos
+             radius:(float)rad
+             rotate:(float)rot
+           numSides:(int)sides
+              color:(simd_float4)color
+{
+  if (sides < 3)
+  {
+    return;
+  }
+  Prim2D::WritePolygonFill([self append:Prim2D::PolygonFillVertices(sides) to:fills_],
+                           pos,
+                           rad,
+                           rot,
+                           sides,
+                           vcvt_f16_f32(color));
+}
+
+//
+- (nullable id<MTLBuffer>)vertexBuffer
+{
+  if (dirty_)
+  {
+    // 描画中のフレームが古いバッファを参照していることがあるので上書きせずに作り直す
+    [buffer_ release];
+    buffer_    = nil;
+    dirty_     = NO;
+    revision_  = NextRevision.fetch_add(1, std::memory_order_relaxed);
+    auto total = fills_.size() + lines_.size();
+    if (total > 0)
+    {
+      buffer_ = [device_ newBufferWithLength:total * sizeof(VertexDataPrim2D)
+                                     options:MTLResourceStorageModeShared];
+      auto *dst = (VertexDataPrim2D *)buffer_.contents;
+      std::memcpy(dst, fills_.data(), fills_.size() * sizeof(VertexDataPrim2D));
+      std::memcpy(dst + fills_.size(), lines_.data(), lines_.size() * sizeof(VertexDataPrim2D));
+      buffer_.label = @"DisplayList2D";
+    }
+  }
+  return buffer_;
+}
+
+@end
@@ -2,31 +2,94 @@
 // Copyright 2024 Y.Suzuki(wave.suzuki.z@gmail.com)
 //
 #import "draw2d.h"
+#include "command_list2d.h"
+#import "display_list.h"
 #include "dsemaphore.h"
 #import "font_render.h"
+#include "frame_arena.h"
+#include "frame_hash.h"
+#include "prim2d_geometry.h"
+#include "radix_sort.h"
 #include "shader_def.h"
+#include "spatial_hash.h"
 #import "sprite.h"
 #import "texture.h"
+#import "texture_cache.h"
 #import <Metal/Metal.h>
+#include <algorithm>
 #include <arm_neon.h>
 #include <cmath>
+#include <cstring>
 #include <list>
 #include <memory>
+#include <memory_resource>
 #include <simd/simd.h>
+#include <unordered_map>
+#include <vector>
 
 namespace
 {
+constexpr NSUInteger MaxLineVertices = 4 * 30000;
+constexpr NSUInteger MaxFillVertices = 4 * 30000;
+constexpr NSUInteger MaxQuadVertices = 6 * 5000;
+
+using Commands2D = CommandList2D<id<MTLBuffer>, id<MTLTexture>>;
+
 // 文字列管理
 struct DrawString
 {
-  Texture    *stringTex_;
-  simd_float2 pos_[4];
-  simd_float4 color_;
-  BOOL        keep_;
+  Texture      *stringTex_ = nil;
+  TextureCache *cache_     = nil;
+  NSUInteger    bytes_     = 0;
+  simd_float2   pos_[4];
+  simd_float4   color_;
+  BOOL          keep_ = NO;
+
+  DrawString()                   = default;
+  DrawString(const DrawString &) = delete;
+  ~DrawString()
+  {
+    [cache_ removeTransientBytes:bytes_];
+    [stringTex_ release];
+  }
+};
 
-  ~DrawString() { [stringTex_ release]; }
+// 当たり判定の索引に入れるスプライトの四角形
+struct SpriteQuad2D
+{
+  uint32_t    handle;
+  simd_float2 corners[4]; // トライアングルストリップ順(ピクセル単位)
+  uint64_t    order;      // 描画順のキー
+};
+
+// フレーム単位のデータ(フレームアリーナ上に置き、次のフレームの描画後に破棄する)
+struct FrameData2D
+{
+  std::pmr::list<DrawString>       strings;
+  std::pmr::vector<Sprite *>       sprites;     // retain済み
+  std::pmr::vector<SpriteQuad2D>   spriteQuads;
+  std::pmr::vector<id<MTLBuffer>>  listBuffers; // retain済み
+  std::pmr::vector<ListInstance2D> listInstances;
+  std::pmr::vector<ClipRect2D>     clipRects; // 番号-1で引く
+  Commands2D::TextureIds           textureIds;
+
+  explicit FrameData2D(std::pmr::memory_resource *resource)
+      : strings(resource), sprites(resource), spriteQuads(resource), listBuffers(resource),
+        listInstances(resource), clipRects(resource), textureIds(resource)
+  {
+  }
+  ~FrameData2D()
+  {
+    for (auto *sprite : sprites)
+    {
+      [sprite release];
+    }
+    for (auto buffer : listBuffers)
+    {
+      [buffer release];
+    }
+  }
 };
-using DrawStringPtr = std::shared_ptr<DrawString>;
 
 } // namespace
 
@@ -53,142 +116,263 @@ using DrawStringPtr = std::shared_ptr<DrawString>;
   id<MTLRenderPipelineState> pipelineStateText_;
   FontRender                *fontRender_;
   id<MTLBuffer>              textVtx_[3];
+  NSUInteger                 nbQuadVertices_;
   simd_float4                textColor_;
   BOOL                       requestClearText_;
-  std::list<DrawStringPtr>   drawStringList;
-  std::list<DrawStringPtr>   drawStringListBack;
 
   // primitive
   id<MTLRenderPipelineState> pipelineStatePrim_;
+  id<MTLRenderPipelineState> pipelineStateList_;
+  id<MTLRenderPipelineState> pipelineStateParticle_;
   id<MTLBuffer>              vertices_[3];
   NSUInteger                 nbPrimitives_;
   id<MTLBuffer>              fillVertices_[3];
   NSUInteger                 nbFillPrimitives_;
+  id<MTLBuffer>              particles_[3];
+  NSUInteger                 nbParticles_;
 
-  //
-  SimpleLock primLock_;
-  SimpleLock fillLock_;
+  // command
+  Commands2D                       cmdList_;
+  std::vector<Commands2D::Command> sortTemp_;
+  uint32_t                         layer_;
+  SimpleLock                       cmdLock_;
+
+  // clip
+  ClipRect2D                                    clipRect_;
+  uint32_t                                      clip_;
+  std::vector<std::pair<uint32_t, ClipRect2D>> clipStack_;
+
+  // 頂点以外で描画内容に関わるもの(文字列・リストの版・フィルタの更新)
+  FrameHash submitHash_;
+  uint64_t  filterSerial_;
 
   // sprite
-  NSMutableArray<Sprite *> *spriteList;
+  // 直前に表示したフレームで描いたもの(スプライトはそのフレームのデータがretainしている)
+  SpatialHash2D spriteIndex_;
+
+  // frame
+  FrameArena   frameArena_[2];
+  FrameData2D *frames_[2];
+  NSUInteger   frameIndex_;
 }
 
-@synthesize screenSize;
+@synthesize screenSize, textureCache;
 
 - (CGFloat)P:(CGFloat)num
 {
   return num * contentScale_;
 }
 
-- (void)drawLine:(simd_float2)from to:(simd_float2)to color:(simd_float4)color
+//
+- (int)layer
 {
-  primLock_.lock();
-  auto  vtx   = vertices_[pageIndex_];
-  auto *vtx2d = (VertexDataPrim2D *)vtx.contents + nbPrimitives_;
+  return (int)layer_ - 0x8000;
+}
 
-  nbPrimitives_ += 2;
-  primLock_.unlock();
+- (void)setLayer:(int)layer
+{
+  layer_ = std::clamp(layer + 0x8000, 0, 0xffff);
+}
 
-  auto col16        = vcvt_f16_f32(color);
-  vtx2d[0].position = from * contentScale_;
-  vtx2d[0].color    = col16;
-  vtx2d[1].position = to * contentScale_;
-  vtx2d[1].color    = col16;
+// 現在のクリップ矩形(無ければ画面全体)
+- (ClipRect2D)activeClip
+{
+  if (clip_ == NoClip)
+  {
+    return {simd_make_float2(0.0f, 0.0f),
+            simd_make_float2(screenSize.width, screenSize.height)};
+  }
+  return clipRect_;
 }
 
-- (void)drawRect:(simd_float2)from to:(simd_float2)to color:(simd_float4)color
+// ピクセル単位の矩形が見えるか
+- (BOOL)visible:(simd_float2)lo to:(simd_float2)hi
 {
-  primLock_.lock();
-  auto  vtx   = vertices_[pageIndex_];
-  auto *vtx2d = (VertexDataPrim2D *)vtx.contents + nbPrimitives_;
-
-  nbPrimitives_ += 8;
-  primLock_.unlock();
-
-  from *= contentScale_;
-  to *= contentScale_;
-
-  auto col16        = vcvt_f16_f32(color);
-  vtx2d[0].position = from;
-  vtx2d[0].color    = col16;
-  vtx2d[1].position = simd_make_float2(to.x, from.y);
-  vtx2d[1].color    = col16;
-  vtx2d[2].position = from;
-  vtx2d[2].color    = col16;
-  vtx2d[3].position = simd_make_float2(from.x, to.y);
-  vtx2d[3].color    = col16;
-  vtx2d[4].position = simd_make_float2(to.x, from.y);
-  vtx2d[4].color    = col16;
-  vtx2d[5].position = to;
-  vtx2d[5].color    = col16;
-  vtx2d[6].position = simd_make_float2(from.x, to.y);
-  vtx2d[6].color    = col16;
-  vtx2d[7].position = to;
-  vtx2d[7].color    = col16;
+  return Overlaps([self activeClip], simd_min(lo, hi), simd_max(lo, hi));
 }
 
-- (void)drawPolygon:(simd_float2)pos
-             radius:(float)rad
-             rotate:(float)rot
-           numSides:(int)sides
-              color:(simd_float4)color
+// 今のクリップ矩形と重なる部分に描画を制限する(ポイント単位)
+- (void)pushClipRect:(simd_float2)from to:(simd_float2)to
+{
+  auto       active = [self activeClip];
+  ClipRect2D rect{simd_max(simd_min(from, to) * contentScale_, active.min),
+                  simd_min(simd_max(from, to) * contentScale_, active.max)};
+  rect.max = simd_max(rect.max, rect.min);
+
+  clipStack_.emplace_back(clip_, clipRect_);
+  SimpleGuard guard{cmdLock_};
+  auto       &clips = frames_[frameIndex_]->clipRects;
+  clips.push_back(rect);
+  clip_     = (uint32_t)clips.size();
+  clipRect_ = rect;
+}
+
+- (void)popClipRect
 {
-  if (sides < 3)
+  if (clipStack_.empty())
   {
     return;
   }
+  clip_     = clipStack_.back().first;
+  clipRect_ = clipStack_.back().second;
+  clipStack_.pop_back();
+}
+
+//
+- (VertexDataPrim2D *)reserve:(NSUInteger)count
+                     pipeline:(Pipeline2D)pipeline
+                      texture:(id<MTLTexture>)texture
+{
+  return [self reserve:count pipeline:pipeline texture:texture bounds:nullptr];
+}
+
+// パイプラインの頂点バッファと使用数
+- (id<MTLBuffer>)vertexBuffer:(Pipeline2D)pipeline
+                      counter:(NSUInteger **)counter
+                     capacity:(NSUInteger *)capacity
+{
+  switch (pipeline)
+  {
+  case PipelineFill:
+    *counter  = &nbFillPrimitives_;
+    *capacity = MaxFillVertices;
+    return fillVertices_[pageIndex_];
+  case PipelineLine:
+    *counter  = &nbPrimitives_;
+    *capacity = MaxLineVertices;
+    return vertices_[pageIndex_];
+  default:
+    *counter  = &nbQuadVertices_;
+    *capacity = MaxQuadVertices;
+    return textVtx_[pageIndex_];
+  }
+}
 
-  primLock_.lock();
-  auto  vtx   = vertices_[pageIndex_];
-  auto *vtx2d = (VertexDataPrim2D *)vtx.contents + nbPrimitives_;
+// 頂点領域を確保してコマンドを積む(直前のコマンドと同じ順番で連続していれば結合する)
+- (VertexDataPrim2D *)reserve:(NSUInteger)count
+                     pipeline:(Pipeline2D)pipeline
+                      texture:(id<MTLTexture>)texture
+                       bounds:(const ClipRect2D *)bounds
+{
+  NSUInteger *counter  = nullptr;
+  NSUInteger  capacity = 0;
+  auto        buffer   = [self vertexBuffer:pipeline counter:&counter capacity:&capacity];
+
+  SimpleGuard guard{cmdLock_};
+  auto        start = cmdList_.reserve(
+      count, pipeline, layer_, clip_, buffer, texture, *counter, capacity, bounds);
+  if (start == Commands2D::NoSpace)
+  {
+    return nullptr;
+  }
+  return (VertexDataPrim2D *)buffer.contents + start;
+}
 
-  nbPrimitives_ += sides * 2;
-  primLock_.unlock();
+// reserve:で確保したうち、endから後ろのunused個を返す
+// 後から別の確保があって返せなければ、面積の無い透明な頂点で埋めておく
+- (void)unreserve:(NSUInteger)unused pipeline:(Pipeline2D)pipeline end:(VertexDataPrim2D *)end
+{
+  NSUInteger *counter  = nullptr;
+  NSUInteger  capacity = 0;
+  auto        buffer   = [self vertexBuffer:pipeline counter:&counter capacity:&capacity];
+  auto        index    = (NSUInteger)(end - (VertexDataPrim2D *)buffer.contents);
 
-  auto col16 = vcvt_f16_f32(color);
+  SimpleGuard guard{cmdLock_};
+  if (!cmdList_.shrink(buffer, *counter, index, unused))
+  {
+    std::memset(end, 0, unused * sizeof(VertexDataPrim2D));
+  }
+}
 
-  float step = (M_PI * 2) / (float)sides;
-  for (int sidx = 0; sidx < sides; sidx++)
+// 四角形(三角形2つ)を書き込む
+// cornerはトライアングルストリップ順(テクスチャ座標はシェーダー側で決まる)
+- (void)addQuad:(const simd_float2 *)corner
+       pipeline:(Pipeline2D)pipeline
+        texture:(id<MTLTexture>)texture
+          color:(simd_float4)color
+{
+  auto  rect  = Bounds(corner, 4);
+  auto *vtx2d = [self reserve:6 pipeline:pipeline texture:texture bounds:&rect];
+  if (vtx2d == nullptr)
   {
-    auto rot1 = (float)sidx * step + rot;
-    auto rot2 = (float)(sidx + 1) * step + rot;
-    auto pos1 = simd_make_float2(std::sin(rot1), std::cos(rot1));
-    auto pos2 = simd_make_float2(std::sin(rot2), std::cos(rot2));
+    return;
+  }
 
-    (*vtx2d).position = (pos1 * rad + pos) * contentScale_;
-    (*vtx2d).color    = col16;
-    vtx2d++;
-    (*vtx2d).position = (pos2 * rad + pos) * contentScale_;
-    (*vtx2d).color    = col16;
-    vtx2d++;
+  static constexpr int order[6] = {0, 1, 2, 2, 1, 3};
+  auto                 col16    = vcvt_f16_f32(color);
+  for (int i = 0; i < 6; i++)
+  {
+    vtx2d[i].position = corner[order[i]];
+    vtx2d[i].color    = col16;
   }
 }
 
-- (void)fillRect:(simd_float2)from to:(simd_float2)to color:(simd_float4)color
+- (void)drawLine:(simd_float2)from to:(simd_float2)to color:(simd_float4)color
 {
-  fillLock_.lock();
-  auto  vtx   = fillVertices_[pageIndex_];
-  auto *vtx2d = (VertexDataPrim2D *)vtx.contents + nbFillPrimitives_;
+  if (![self visible:from * contentScale_ to:to * contentScale_])
+  {
+    return;
+  }
+  auto *vtx2d = [self reserve:Prim2D::LineVertices pipeline:PipelineLine texture:nil];
+  if (vtx2d == nullptr)
+  {
+    return;
+  }
+  Prim2D::WriteLine(vtx2d, from * contentScale_, to * contentScale_, vcvt_f16_f32(color));
+}
+
+- (void)drawRect:(simd_float2)from to:(simd_float2)to color:(simd_float4)color
+{
+  if (![self visible:from * contentScale_ to:to * contentScale_])
+  {
+    return;
+  }
+  auto *vtx2d = [self reserve:Prim2D::RectLineVertices pipeline:PipelineLine texture:nil];
+  if (vtx2d == nullptr)
+  {
+    return;
+  }
+  Prim2D::WriteRectLines(vtx2d, from * contentScale_, to * contentScale_, vcvt_f16_f32(color));
+}
 
-  nbFillPrimitives_ += 6;
-  fillLock_.unlock();
+- (void)drawPolygon:(simd_float2)pos
+             radius:(float)rad
+             rotate:(float)rot
+           numSides:(int)sides
+              color:(simd_float4)color
+{
+  if (sides < 3 || ![self visible:(pos - rad) * contentScale_ to:(pos + rad) * contentScale_])
+  {
+    return;
+  }
 
-  from *= contentScale_;
-  to *= contentScale_;
+  auto *vtx2d = [self reserve:Prim2D::PolygonLineVertices(sides)
+                     pipeline:PipelineLine
+                      texture:nil];
+  if (vtx2d == nullptr)
+  {
+    return;
+  }
+  Prim2D::WritePolygonLines(vtx2d,
+                            pos * contentScale_,
+                            rad * contentScale_,
+                            rot,
+                            sides,
+                            vcvt_f16_f32(color));
+}
 
-  auto col16        = vcvt_f16_f32(color);
-  vtx2d[0].position = from;
-  vtx2d[0].color    = col16;
-  vtx2d[1].position = simd_make_float2(to.x, from.y);
-  vtx2d[1].color    = col16;
-  vtx2d[2].position = simd_make_float2(from.x, to.y);
-  vtx2d[2].color    = col16;
-  vtx2d[3].position = simd_make_float2(to.x, from.y);
-  vtx2d[3].color    = col16;
-  vtx2d[4].position = simd_make_float2(from.x, to.y);
-  vtx2d[4].color    = col16;
-  vtx2d[5].position = to;
-  vtx2d[5].color    = col16;
+- (void)fillRect:(simd_float2)from to:(simd_float2)to color:(simd_float4)color
+{
+  if (![self visible:from * contentScale_ to:to * contentScale_])
+  {
+    return;
+  }
+  auto *vtx2d = [self reserve:Prim2D::RectFillVertices pipeline:PipelineFill texture:nil];
+  if (vtx2d == nullptr)
+  {
+    return;
+  }
+  Prim2D::WriteRectFill(vtx2d, from * contentScale_, to * contentScale_, vcvt_f16_f32(color));
 }
 
 - (void)fillPolygon:(simd_float2)pos
@@ -197,38 +381,209 @@ using DrawStringPtr = std::shared_ptr<DrawString>;
            numSides:(int)sides
               color:(simd_float4)color
 {
-  if (sides < 3)
+  if (sides < 3 || ![self visible:(pos - rad) * contentScale_ to:(pos + rad) * contentScale_])
+  {
+    return;
+  }
+
+  auto *vtx2d = [self reserve:Prim2D::PolygonFillVertices(sides)
+                     pipeline:PipelineFill
+                      texture:nil];
+  if (vtx2d == nullptr)
+  {
+    return;
+  }
+  Prim2D::WritePolygonFill(vtx2d,
+                           pos * contentScale_,
+                           rad * contentScale_,
+                           rot,
+                           sides,
+                           vcvt_f16_f32(color));
+}
+
+//
+- (void)drawLines:(nonnull const Line2D *)lines count:(NSUInteger)count
+{
+  auto  clip    = [self activeClip];
+  float scale   = contentScale_;
+  auto  visible = [&](const Line2D &line)
+  {
+    auto from = line.from * scale;
+    auto to   = line.to * scale;
+    return Overlaps(clip, simd_min(from, to), simd_max(from, to));
+  };
+  auto reserve = [&](size_t nbVertices)
+  { return [self reserve:nbVertices pipeline:PipelineLine texture:nil]; };
+  auto release = [&](VertexDataPrim2D *end, size_t unused)
+  { [self unreserve:unused pipeline:PipelineLine end:end]; };
+  auto write = [&](VertexDataPrim2D *vtx2d, const Line2D &line)
+  { Prim2D::WriteLine(vtx2d, line.from * scale, line.to * scale, vcvt_f16_f32(line.color)); };
+  Prim2D::WriteVisible(lines, count, Prim2D::LineVertices, visible, reserve, write, release);
+}
+
+- (void)drawRects:(nonnull const Rect2D *)rects count:(NSUInteger)count
+{
+  auto  clip    = [self activeClip];
+  float scale   = contentScale_;
+  auto  visible = [&](const Rect2D &rect)
+  {
+    auto from = rect.from * scale;
+    auto to   = rect.to * scale;
+    return Overlaps(clip, simd_min(from, to), simd_max(from, to));
+  };
+  auto reserve = [&](size_t nbVertices)
+  { return [self reserve:nbVertices pipeline:PipelineLine texture:nil]; };
+  auto release = [&](VertexDataPrim2D *end, size_t unused)
+  { [self unreserve:unused pipeline:PipelineLine end:end]; };
+  auto write = [&](VertexDataPrim2D *vtx2d, const Rect2D &rect)
+  {
+    Prim2D::WriteRectLines(vtx2d, rect.from * scale, rect.to * scale, vcvt_f16_f32(rect.color));
+  };
+  Prim2D::WriteVisible(rects, count, Prim2D::RectLineVertices, visible, reserve, write, release);
+}
+
+- (void)fillRects:(nonnull const Rect2D *)rects count:(NSUInteger)count
+{
+  auto  clip    = [self activeClip];
+  float scale   = contentScale_;
+  auto  visible = [&](const Rect2D &rect)
+  {
+    auto from = rect.from * scale;
+    auto to   = rect.to * scale;
+    return Overlaps(clip, simd_min(from, to), simd_max(from, to));
+  };
+  auto reserve = [&](size_t nbVertices)
+  { return [self reserve:nbVertices pipeline:PipelineFill texture:nil]; };
+  auto release = [&](VertexDataPrim2D *end, size_t unused)
+  { [self unreserve:unused pipeline:PipelineFill end:end]; };
+  auto write = [&](VertexDataPrim2D *vtx2d, const Rect2D &rect)
+  {
+    Prim2D::WriteRectFill(vtx2d, rect.from * scale, rect.to * scale, vcvt_f16_f32(rect.color));
+  };
+  Prim2D::WriteVisible(rects, count, Prim2D::RectFillVertices, visible, reserve, write, release);
+}
+
+// 1粒子につき6頂点(四角形への展開はシェーダーで行う)
+- (void)drawParticles:(const Particle::System &)system
+{
+  // 粒子毎には判定せず、はみ出した分はシザーで切る
+  auto count = system.size();
+  if (count == 0 || IsEmpty([self activeClip]))
   {
     return;
   }
 
-  fillLock_.lock();
-  auto  vtx   = fillVertices_[pageIndex_];
-  auto *vtx2d = (VertexDataPrim2D *)vtx.contents + nbFillPrimitives_;
+  // 書き込み中にバッファを差し替えられないようにロックしたまま書き出す
+  SimpleGuard guard{cmdLock_};
+  auto        buffer = particles_[pageIndex_];
+  auto        needed = (nbParticles_ + count) * sizeof(ParticleData);
+  if (buffer.length < needed)
+  {
+    // 足りなければ大きくして作り直し、記録済みのコマンドも付け替える
+    auto length = std::max<NSUInteger>(needed, buffer.length * 2);
+    auto grown  = [device_ newBufferWithLength:length options:MTLResourceStorageModeShared];
+    if (buffer != nil)
+    {
+      std::memcpy(grown.contents, buffer.contents, nbParticles_ * sizeof(ParticleData));
+      for (auto &cmd : cmdList_.commands())
+      {
+        if (cmd.buffer_ == buffer)
+        {
+          cmd.buffer_ = grown;
+        }
+      }
+      [buffer release];
+    }
+    grown.label            = @"Particle2D";
+    particles_[pageIndex_] = buffer = grown;
+  }
 
-  nbFillPrimitives_ += sides * 3;
-  fillLock_.unlock();
+  auto start = nbParticles_;
+  system.writeAll((Particle::Vertex *)buffer.contents + start, contentScale_);
+  nbParticles_ += count;
+
+  Commands2D::Command cmd;
+  cmd.key_         = cmdList_.sortKey(layer_, PipelineParticle, 0, nullptr);
+  cmd.pipeline_    = PipelineParticle;
+  cmd.layer_       = layer_;
+  cmd.vertexStart_ = (uint32_t)(start * 6);
+  cmd.vertexCount_ = (uint32_t)(count * 6);
+  cmd.instance_    = NoInstance;
+  cmd.clip_        = clip_;
+  cmd.buffer_      = buffer;
+  cmd.texture_     = nil;
+  cmdList_.commands().push_back(cmd);
+}
 
-  auto col16 = vcvt_f16_f32(color);
+//
+- (nonnull DisplayList2D *)newDisplayList
+{
+  return [[DisplayList2D alloc] initWithDevice:device_];
+}
 
-  float step = (M_PI * 2) / (float)sides;
-  for (int sidx = 0; sidx < sides; sidx++)
+// 記録済みのリストを描画する(頂点はリスト側のバッファをそのまま使う)
+- (void)drawDisplayList:(nonnull DisplayList2D *)list
+              transform:(simd_float3x2)transform
+                  color:(simd_float4)color
+{
+  auto buffer = [list vertexBuffer];
+  if (buffer == nil)
   {
-    auto rot1 = (float)sidx * step + rot;
-    auto rot2 = (float)(sidx + 1) * step + rot;
-    auto pos1 = simd_make_float2(std::sin(rot1), std::cos(rot1));
-    auto pos2 = simd_make_float2(std::sin(rot2), std::cos(rot2));
+    return;
+  }
 
-    (*vtx2d).position = pos * contentScale_;
-    (*vtx2d).color    = col16;
-    vtx2d++;
-    (*vtx2d).position = (pos1 * rad + pos) * contentScale_;
-    (*vtx2d).color    = col16;
-    vtx2d++;
-    (*vtx2d).position = (pos2 * rad + pos) * contentScale_;
-    (*vtx2d).color    = col16;
-    vtx2d++;
+  // 記録範囲の四隅を変換して見えるか調べる
+  auto        bounds    = list.bounds;
+  simd_float2 corner[4] = {bounds.xy,
+                           bounds.zw,
+                           simd_make_float2(bounds.z, bounds.y),
+                           simd_make_float2(bounds.x, bounds.w)};
+  for (auto &pos : corner)
+  {
+    pos = simd_mul(transform, simd_make_float3(pos, 1.0f)) * contentScale_;
   }
+  auto rect = Bounds(corner, 4);
+  if (![self visible:rect.min to:rect.max])
+  {
+    return;
+  }
+
+  // ポイント→ピクセルの変換も含める
+  ListInstance2D instance;
+  instance.transform = simd_matrix(transform.columns[0] * contentScale_,
+                                   transform.columns[1] * contentScale_,
+                                   transform.columns[2] * contentScale_);
+  instance.color     = color;
+
+  SimpleGuard guard{cmdLock_};
+  auto       &frame         = *frames_[frameIndex_];
+  auto        instanceIndex = (uint32_t)frame.listInstances.size();
+  frame.listInstances.push_back(instance);
+  submitHash_.add(list.revision);
+
+  frame.listBuffers.push_back([buffer retain]);
+
+  auto bufId = cmdList_.stateId((__bridge void *)buffer);
+  auto push  = [&](Pipeline2D pipeline, NSUInteger start, NSUInteger count)
+  {
+    if (count == 0)
+    {
+      return;
+    }
+    Commands2D::Command cmd;
+    cmd.key_         = cmdList_.sortKey(layer_, pipeline, bufId, &rect);
+    cmd.pipeline_    = pipeline;
+    cmd.layer_       = layer_;
+    cmd.vertexStart_ = (uint32_t)start;
+    cmd.vertexCount_ = (uint32_t)count;
+    cmd.instance_    = instanceIndex;
+    cmd.clip_        = clip_;
+    cmd.buffer_      = buffer;
+    cmd.texture_     = nil;
+    cmdList_.commands().push_back(cmd);
+  };
+  push(PipelineListFill, 0, list.fillVertexCount);
+  push(PipelineListLine, list.fillVertexCount, list.lineVertexCount);
 }
 
 // テキスト描画カラー
@@ -240,21 +595,40 @@ using DrawStringPtr = std::shared_ptr<DrawString>;
 // テキスト描画
 - (void)print:(nonnull NSString *)message x:(CGFloat)x y:(CGFloat)y keep:(BOOL)keep
 {
+  // 文字列のテクスチャは毎フレーム作り直すので、比較には内容を使う
+  const char *utf8     = message.UTF8String;
+  auto        textHash = FrameHash::Compute(utf8, std::strlen(utf8));
   [fontRender_ Render:message
              callback:^(CGContextRef ctx, CGRect rect) {
-               auto dstr        = std::make_shared<DrawString>();
-               dstr->stringTex_ = [[Texture alloc] initWithMemory:ctx device:device_];
-               dstr->color_     = textColor_;
-               dstr->keep_      = keep;
                const CGFloat x1 = [self P:x + rect.origin.x];
                const CGFloat y1 = [self P:y + rect.origin.y];
                const CGFloat x2 = x1 + [self P:rect.size.width];
                const CGFloat y2 = y1 + [self P:rect.size.height];
+               // 見えなければテクスチャも作らない
+               if (![self visible:simd_make_float2(x1, y1) to:simd_make_float2(x2, y2)])
+               {
+                 return;
+               }
+               DrawString *dstr = nullptr;
+               {
+                 SimpleGuard guard{cmdLock_};
+                 dstr = &frames_[frameIndex_]->strings.emplace_back();
+                 submitHash_.add(textHash);
+               }
+               dstr->stringTex_ = [[Texture alloc] initWithMemory:ctx device:device_];
+               dstr->cache_     = textureCache;
+               dstr->bytes_     = dstr->stringTex_.object.allocatedSize;
+               dstr->color_     = textColor_;
+               dstr->keep_      = keep;
                dstr->pos_[0]    = simd_make_float2(x2, y1);
                dstr->pos_[1]    = simd_make_float2(x1, y1);
                dstr->pos_[2]    = simd_make_float2(x2, y2);
                dstr->pos_[3]    = simd_make_float2(x1, y2);
-               drawStringList.push_back(dstr);
+               [textureCache addTransientBytes:dstr->bytes_];
+               [self addQuad:dstr->pos_
+                    pipeline:PipelineText
+                     texture:dstr->stringTex_.object
+                       color:dstr->color_];
              }];
 }
 
@@ -307,6 +681,25 @@ using DrawStringPtr = std::shared_ptr<DrawString>;
 
   pipelineStatePrim_ = [device_ newRenderPipelineStateWithDescriptor:pipelineDesc error:&error];
 
+  // display list
+  auto vertexListFunction = [library newFunctionWithName:@"listVert2d"];
+
+  pipelineDesc.label          = @"PipelineList2D";
+  pipelineDesc.vertexFunction = vertexListFunction;
+
+  pipelineStateList_ = [device_ newRenderPipelineStateWithDescriptor:pipelineDesc error:&error];
+
+  // particle
+  auto vertexParticleFunction   = [library newFunctionWithName:@"particleVert2d"];
+  auto fragmentParticleFunction = [library newFunctionWithName:@"particleFrag"];
+
+  pipelineDesc.label            = @"PipelineParticle2D";
+  pipelineDesc.vertexFunction   = vertexParticleFunction;
+  pipelineDesc.fragmentFunction = fragmentParticleFunction;
+
+  pipelineStateParticle_ = [device_ newRenderPipelineStateWithDescriptor:pipelineDesc
+                                                                   error:&error];
+
   [pipelineDesc release];
   return YES;
 }
@@ -336,7 +729,21 @@ using DrawStringPtr = std::shared_ptr<DrawString>;
     contentScale_  = [[NSScreen mainScreen] backingScaleFactor];
     pageIndex_     = 0;
     nbPrimitives_  = 0;
-    spriteList     = [[NSMutableArray alloc] init];
+    frameIndex_    = 0;
+    clip_          = NoClip;
+    clipRect_      = {};
+    filterSerial_  = 0;
+    for (int i = 0; i < 2; i++)
+    {
+      frames_[i] = frameArena_[i].create<FrameData2D>(frameArena_[i].resource());
+    }
+    cmdList_.reset(&frames_[frameIndex_]->textureIds);
+    textureCache   = [[TextureCache alloc] initWithDevice:device_];
+
+    nbFillPrimitives_ = 0;
+    nbQuadVertices_   = 0;
+    nbParticles_      = 0;
+    layer_            = 0x8000;
 
     uniformBuffer_.label = @"UniformBuffer2D";
 
@@ -348,11 +755,11 @@ using DrawStringPtr = std::shared_ptr<DrawString>;
 
     for (int i = 0; i < 3; i++)
     {
-      textVtx_[i]      = [device_ newBufferWithLength:sizeof(VertexDataPrim2D) * 4 * 5000
+      textVtx_[i]      = [device_ newBufferWithLength:sizeof(VertexDataPrim2D) * MaxQuadVertices
                                          options:MTLResourceStorageModeShared];
-      vertices_[i]     = [device_ newBufferWithLength:sizeof(VertexDataPrim2D) * 4 * 30000
+      vertices_[i]     = [device_ newBufferWithLength:sizeof(VertexDataPrim2D) * MaxLineVertices
                                           options:MTLResourceStorageModeShared];
-      fillVertices_[i] = [device_ newBufferWithLength:sizeof(VertexDataPrim2D) * 4 * 30000
+      fillVertices_[i] = [device_ newBufferWithLength:sizeof(VertexDataPrim2D) * MaxFillVertices
                                               options:MTLResourceStorageModeShared];
     }
     requestClearText_ = NO;
@@ -367,70 +774,43 @@ using DrawStringPtr = std::shared_ptr<DrawString>;
 //
 - (void)dealloc
 {
-  [spriteList release];
+  for (int i = 0; i < 2; i++)
+  {
+    frames_[i]->~FrameData2D();
+  }
+  [textureCache release];
   for (int i = 0; i < 3; i++)
   {
     [textVtx_[i] release];
     [vertices_[i] release];
     [fillVertices_[i] release];
+    [particles_[i] release];
   }
   [fontRender_ release];
   [uniformBuffer_ release];
   [depthState_ release];
   [pipelineStateText_ release];
   [pipelineStatePrim_ release];
+  [pipelineStateList_ release];
+  [pipelineStateParticle_ release];
   [super dealloc];
 }
 
-//
-- (void)setupDrawText
-{
-  auto               textVtx  = textVtx_[pageIndex_];
-  __block NSUInteger vtxCount = 0;
-  [spriteList
-      enumerateObjectsUsingBlock:^(Sprite *_Nonnull obj, NSUInteger idx, BOOL *_Nonnull stop) {
-        auto  poslist = [obj update];
-        auto *sprvtx  = (VertexDataPrim2D *)textVtx.contents + vtxCount;
-        for (int i = 0; i < 4; i++)
-        {
-          sprvtx[i].position = poslist[i];
-          sprvtx[i].color    = vcvt_f16_f32(obj.color);
-        }
-        vtxCount += 4;
-      }];
-  for (auto dstr : drawStringList)
-  {
-    auto *vtx2d = (VertexDataPrim2D *)textVtx.contents + vtxCount;
-    for (int i = 0; i < 4; i++)
-    {
-      vtx2d[i].position = dstr->pos_[i];
-      vtx2d[i].color    = vcvt_f16_f32(dstr->color_);
-    }
-    vtxCount += 4;
-  }
-  [textVtx didModifyRange:NSMakeRange(0, vtxCount * sizeof(VertexDataPrim2D))];
-}
-
-//
-- (void)drawText:(id<MTLRenderCommandEncoder>)renderEncoder
-{
-  __block NSUInteger vtxCount = 0;
-  [spriteList
-      enumerateObjectsUsingBlock:^(Sprite *_Nonnull obj, NSUInteger idx, BOOL *_Nonnull stop) {
-        [renderEncoder setFragmentTexture:obj.texObj atIndex:TextureIndexColor];
-        [renderEncoder drawPrimitives:MTLPrimitiveTypeTriangleStrip
-                          vertexStart:vtxCount
-                          vertexCount:4];
-        vtxCount += 4;
-      }];
-  for (auto dstr : drawStringList)
+// クリップ矩形をシザー矩形にする(描画先からはみ出さないように丸める)
+- (MTLScissorRect)scissorRect:(uint32_t)clip
+{
+  auto width  = (NSUInteger)screenSize.width;
+  auto height = (NSUInteger)screenSize.height;
+  if (clip == NoClip)
   {
-    [renderEncoder setFragmentTexture:dstr->stringTex_.object atIndex:TextureIndexColor];
-    [renderEncoder drawPrimitives:MTLPrimitiveTypeTriangleStrip vertexStart:vtxCount vertexCount:4];
-    vtxCount += 4;
+    return {0, 0, width, height};
   }
-  drawStringList.swap(drawStringListBack);
-  drawStringList.clear();
+  const auto &rect = frames_[frameIndex_]->clipRects[clip - 1];
+  auto        x0   = std::min((NSUInteger)std::max(std::floor(rect.min.x), 0.0f), width);
+  auto        y0   = std::min((NSUInteger)std::max(std::floor(rect.min.y), 0.0f), height);
+  auto        x1   = std::min((NSUInteger)std::max(std::ceil(rect.max.x), 0.0f), width);
+  auto        y1   = std::min((NSUInteger)std::max(std::ceil(rect.max.y), 0.0f), height);
+  return {x0, y0, std::max(x1, x0) - x0, std::max(y1, y0) - y0};
 }
 
 // 描画
@@ -443,81 +823,178 @@ using DrawStringPtr = std::shared_ptr<DrawString>;
   uniform2d->size[1] = screenSize.height;
 
   [renderEncoder setDepthStencilState:depthState_];
+  [renderEncoder setVertexBuffer:uniformBuffer_ offset:0 atIndex:1];
+  [renderEncoder setFragmentBuffer:uniformBuffer_ offset:0 atIndex:1];
 
-  if (nbPrimitives_ > 0 || nbFillPrimitives_ > 0)
+  // フレーム毎の頂点バッファ
+  id<MTLBuffer> buffers[] = {fillVertices_[pageIndex_], vertices_[pageIndex_], textVtx_[pageIndex_]};
+  NSUInteger    counts[]  = {nbFillPrimitives_, nbPrimitives_, nbQuadVertices_};
+  for (int i = 0; i < 3; i++)
   {
-    [renderEncoder setRenderPipelineState:pipelineStatePrim_];
+    if (counts[i] > 0)
+    {
+      [buffers[i] didModifyRange:NSMakeRange(0, counts[i] * sizeof(VertexDataPrim2D))];
+    }
   }
-
-  if (nbFillPrimitives_ > 0)
+  if (nbParticles_ > 0)
   {
-    // fill primitive draw
-    auto vtx = fillVertices_[pageIndex_];
-    [vtx didModifyRange:NSMakeRange(0, nbFillPrimitives_ * sizeof(VertexDataPrim2D))];
-
-    [renderEncoder setVertexBuffer:uniformBuffer_ offset:0 atIndex:1];
-    [renderEncoder setFragmentBuffer:uniformBuffer_ offset:0 atIndex:1];
-    [renderEncoder setVertexBuffer:vtx offset:0 atIndex:0];
-    [renderEncoder drawPrimitives:MTLPrimitiveTypeTriangle
-                      vertexStart:0
-                      vertexCount:nbFillPrimitives_];
-    nbFillPrimitives_ = 0;
+    [particles_[pageIndex_] didModifyRange:NSMakeRange(0, nbParticles_ * sizeof(ParticleData))];
   }
 
-  if (nbPrimitives_ > 0)
+  // レイヤー→パイプライン→世代→テクスチャ→登録順
+  auto &commands = cmdList_.commands();
+  RadixSort(commands, sortTemp_, [](const Commands2D::Command &cmd) { return cmd.key_; });
+  const auto &frame = *frames_[frameIndex_];
+
+  // 同じ状態で頂点が連続するものは1回の描画にまとめる
+  id<MTLRenderPipelineState> boundPipeline = nil;
+  id<MTLBuffer>              boundBuffer   = nil;
+  id<MTLTexture>             boundTexture  = nil;
+  uint32_t                   boundClip     = NoClip;
+  for (size_t i = 0; i < commands.size();)
   {
-    // primitive draw
-    auto vtx = vertices_[pageIndex_];
-    [vtx didModifyRange:NSMakeRange(0, nbPrimitives_ * sizeof(VertexDataPrim2D))];
+    const auto &cmd   = commands[i];
+    auto        start = cmd.vertexStart_;
+    auto        count = cmd.vertexCount_;
+    size_t      next  = i + 1;
+    while (next < commands.size())
+    {
+      const auto &other = commands[next];
+      if (other.pipeline_ != cmd.pipeline_ || other.texture_ != cmd.texture_ ||
+          other.buffer_ != cmd.buffer_ || other.instance_ != cmd.instance_ ||
+          other.clip_ != cmd.clip_ || other.vertexStart_ != start + count)
+      {
+        break;
+      }
+      count += other.vertexCount_;
+      next++;
+    }
 
-    [renderEncoder setVertexBuffer:uniformBuffer_ offset:0 atIndex:1];
-    [renderEncoder setFragmentBuffer:uniformBuffer_ offset:0 atIndex:1];
-    [renderEncoder setVertexBuffer:vtx offset:0 atIndex:0];
-    [renderEncoder drawPrimitives:MTLPrimitiveTypeLine vertexStart:0 vertexCount:nbPrimitives_];
-    nbPrimitives_ = 0;
+    auto textured = cmd.pipeline_ >= PipelineSprite;
+    auto pipeline = pipelineStatePrim_;
+    if (textured)
+    {
+      pipeline = pipelineStateText_;
+    }
+    else if (cmd.instance_ != NoInstance)
+    {
+      pipeline = pipelineStateList_;
+    }
+    else if (cmd.pipeline_ == PipelineParticle)
+    {
+      pipeline = pipelineStateParticle_;
+    }
+    if (pipeline != boundPipeline)
+    {
+      [renderEncoder setRenderPipelineState:pipeline];
+      boundPipeline = pipeline;
+    }
+    if (cmd.buffer_ != boundBuffer)
+    {
+      boundBuffer = cmd.buffer_;
+      [renderEncoder setVertexBuffer:boundBuffer offset:0 atIndex:0];
+    }
+    if (cmd.instance_ != NoInstance)
+    {
+      [renderEncoder setVertexBytes:&frame.listInstances[cmd.instance_]
+                             length:sizeof(ListInstance2D)
+                            atIndex:2];
+    }
+    if (cmd.clip_ != boundClip)
+    {
+      boundClip = cmd.clip_;
+      [renderEncoder setScissorRect:[self scissorRect:boundClip]];
+    }
+    if (textured && cmd.texture_ != boundTexture)
+    {
+      boundTexture = cmd.texture_;
+      [renderEncoder setFragmentTexture:boundTexture atIndex:TextureIndexColor];
+    }
+
+    auto isLine   = cmd.pipeline_ == PipelineLine || cmd.pipeline_ == PipelineListLine;
+    auto primType = isLine ? MTLPrimitiveTypeLine : MTLPrimitiveTypeTriangle;
+    [renderEncoder drawPrimitives:primType vertexStart:start vertexCount:count];
+    i = next;
+  }
+  if (boundClip != NoClip)
+  {
+    [renderEncoder setScissorRect:[self scissorRect:NoClip]];
   }
 
-  // text draw
-  [renderEncoder setRenderPipelineState:pipelineStateText_];
+  [renderEncoder popDebugGroup];
 
-  [renderEncoder setVertexBuffer:uniformBuffer_ offset:0 atIndex:1];
-  [renderEncoder setFragmentBuffer:uniformBuffer_ offset:0 atIndex:1];
+  [self finishFrame:YES];
+}
 
-  [self setupDrawText];
-  [renderEncoder setVertexBuffer:textVtx_[pageIndex_] offset:0 atIndex:0];
-  [self drawText:renderEncoder];
+// 描画せずにこのフレームの内容を捨てる
+- (void)discardFrame
+{
+  [self finishFrame:NO];
+}
 
-  [renderEncoder popDebugGroup];
+// 記録を片付けて次のフレームに備える
+// 描画しなかった時はGPUに渡していないのでページは進めず、直前に描画したフレームのデータも残す
+- (void)finishFrame:(BOOL)rendered
+{
+  clip_ = NoClip;
+  clipStack_.clear();
+  submitHash_.reset();
+  nbPrimitives_     = 0;
+  nbFillPrimitives_ = 0;
+  nbQuadVertices_   = 0;
+  nbParticles_      = 0;
+
+  // 前のフレームのデータを破棄して次のフレームに使う
+  if (rendered)
+  {
+    [self updateSpriteIndex];
+    frameIndex_ ^= 1;
+  }
+  frames_[frameIndex_]->~FrameData2D();
+  frameArena_[frameIndex_].reset();
+  frames_[frameIndex_] =
+      frameArena_[frameIndex_].create<FrameData2D>(frameArena_[frameIndex_].resource());
+  cmdList_.reset(&frames_[frameIndex_]->textureIds);
+  [textureCache endFrame];
+  if (rendered)
+  {
+    pageIndex_ = (pageIndex_ + 1) % 3;
+  }
+}
+
+// このフレームで積んだ描画内容のハッシュ(Updateの後、render:の前に呼ぶ)
+// 頂点バッファはページ毎に替わるので、ポインタではなく中身と数で比べる
+- (uint64_t)frameHash
+{
+  FrameHash hash{submitHash_.digest()};
+  hash.add(screenSize);
+  cmdList_.addHash(hash);
+  hash.update(fillVertices_[pageIndex_].contents, nbFillPrimitives_ * sizeof(VertexDataPrim2D));
+  hash.update(vertices_[pageIndex_].contents, nbPrimitives_ * sizeof(VertexDataPrim2D));
+  hash.update(textVtx_[pageIndex_].contents, nbQuadVertices_ * sizeof(VertexDataPrim2D));
+  if (nbParticles_ > 0)
+  {
+    hash.update(particles_[pageIndex_].contents, nbParticles_ * sizeof(ParticleData));
+  }
 
-  [spriteList removeAllObjects];
-  pageIndex_ = (pageIndex_ + 1) % 3;
+  const auto &frame = *frames_[frameIndex_];
+  hash.update(frame.listInstances.data(), frame.listInstances.size() * sizeof(ListInstance2D));
+  hash.update(frame.clipRects.data(), frame.clipRects.size() * sizeof(ClipRect2D));
+  return hash.digest();
 }
 
-//
+// 同じファイルはテクスチャを共有する
 - (nonnull NSArray<Sprite *> *)createSprites:(nonnull NSArray<NSString *> *)fileList
 {
-  auto texloader = [[MTKTextureLoader alloc] initWithDevice:device_];
-
-  NSMutableArray<NSURL *> *urlList = [[NSMutableArray alloc] init];
+  NSMutableArray<Sprite *> *sprList = [[NSMutableArray alloc] init];
   [fileList
       enumerateObjectsUsingBlock:^(NSString *_Nonnull obj, NSUInteger idx, BOOL *_Nonnull stop) {
-        NSURL *fURL = [[NSBundle mainBundle] URLForResource:obj withExtension:nil];
-        [urlList addObject:fURL];
+        if (auto tex = [textureCache textureWithFile:obj])
+        {
+          auto spr = [[Sprite alloc] initWithTexture:tex cache:textureCache];
+          [sprList addObject:spr];
+        }
       }];
-
-  NSMutableArray<Sprite *> *sprList = [[NSMutableArray alloc] init];
-  [texloader newTexturesWithContentsOfURLs:urlList
-                                   options:nil
-                         completionHandler:^(NSArray<id<MTLTexture>> *_Nonnull textures,
-                                             NSError *_Nullable error) {
-                           [textures enumerateObjectsUsingBlock:^(id<MTLTexture> _Nonnull obj,
-                                                                  NSUInteger idx,
-                                                                  BOOL *_Nonnull stop) {
-                             auto spr = [[Sprite alloc] initWithTexture:obj];
-                             [sprList addObject:spr];
-                           }];
-                         }];
-  [urlList release];
   return sprList;
 }
 
@@ -536,8 +1013,8 @@ using DrawStringPtr = std::shared_ptr<DrawString>;
         texdesc.textureType = MTLTextureType2D;
         texdesc.storageMode = MTLStorageModeManaged;
         texdesc.usage       = MTLResourceUsageRead | MTLResourceUsageWrite;
-        auto tex            = [device_ newTextureWithDescriptor:texdesc];
-        auto spr            = [[Sprite alloc] initWithImage:img texture:tex];
+        auto tex            = [textureCache uniqueTextureWithDescriptor:texdesc];
+        auto spr            = [[Sprite alloc] initWithImage:img texture:tex cache:textureCache];
         [sprList addObject:spr];
         [spr release];
         [texdesc release];
@@ -548,7 +1025,72 @@ using DrawStringPtr = std::shared_ptr<DrawString>;
 //
 - (void)drawSprite:(Sprite *)sprite
 {
-  [spriteList addObject:sprite];
+  const auto &poslist = [sprite update];
+  {
+    // 見えないものも当たり判定には入れる(索引にある間は破棄されないようにretainしておく)
+    SimpleGuard guard{cmdLock_};
+    auto       *frame = frames_[frameIndex_];
+    auto        seq   = (uint32_t)frame->spriteQuads.size();
+
+    // 重なるスプライト同士は登録順に描かれるので、テクスチャは含めない
+    SpriteQuad2D quad;
+    quad.handle = sprite.handle;
+    quad.order  = MakeSortKey(layer_, PipelineSprite, 0, 0, seq);
+    std::copy(poslist.begin(), poslist.end(), quad.corners);
+    frame->spriteQuads.push_back(quad);
+    frame->sprites.push_back([sprite retain]);
+  }
+
+  auto rect = Bounds(poslist.data(), poslist.size());
+  if (![self visible:rect.min to:rect.max])
+  {
+    return;
+  }
+  BOOL filtered = [sprite applyImageFilter];
+  [self addQuad:poslist.data() pipeline:PipelineSprite texture:sprite.texObj color:sprite.color];
+  if (filtered)
+  {
+    // テクスチャの中身だけが変わった
+    SimpleGuard guard{cmdLock_};
+    submitHash_.add(++filterSerial_);
+  }
+}
+
+// 表示するフレームのスプライトで索引を更新する(描かなかったものは取り除く)
+// 描画を省いたフレームは画面に出ないので、索引は最後に表示したものを指したままにする
+- (void)updateSpriteIndex
+{
+  spriteIndex_.beginFrame();
+  for (const auto &quad : frames_[frameIndex_]->spriteQuads)
+  {
+    spriteIndex_.update(quad.handle, quad.corners, quad.order);
+  }
+  spriteIndex_.sweep();
+}
+
+// 結果は手前にあるものから並ぶ
+- (void)querySpritesAt:(simd_float2)point result:(std::vector<uint32_t> &)result
+{
+  result.clear();
+  spriteIndex_.queryPoint(point, result);
+}
+
+- (void)querySpritesIn:(simd_float2)from to:(simd_float2)to result:(std::vector<uint32_t> &)result
+{
+  result.clear();
+  spriteIndex_.queryRect(from, to, result);
+}
+
+- (void)querySpriteOverlaps:(uint32_t)handle result:(std::vector<uint32_t> &)result
+{
+  result.clear();
+  spriteIndex_.queryOverlaps(handle, result);
+}
+
+- (void)querySpritePairs:(std::vector<std::pair<uint32_t, uint32_t>> &)result
+{
+  result.clear();
+  spriteIndex_.queryPairs(result);
 }
 
 @end
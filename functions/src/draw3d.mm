@@ -4,12 +4,36 @@
 #import "draw3d.h"
 #import "camera.h"
 #include "dsemaphore.h"
+#include "frame_hash.h"
+#include "parallel_for.h"
+#include "prim3d_batch.h"
 #include "shader_def.h"
+#include "translucent_sort.h"
 #import <Metal/Metal.h>
 #include <arm_neon.h>
-#include <list>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <memory>
 #include <simd/simd.h>
+#include <vector>
+
+static_assert(sizeof(Particle::Vertex) == sizeof(ParticleData));
+
+namespace
+{
+constexpr NSUInteger MaxLineVertices     = 4 * 30000;
+constexpr NSUInteger MaxTriangleVertices = 3 * 100000;
+
+// Mesh3Dの描画(バッファは描画が終わるまで保持する)
+struct MeshDraw3D
+{
+  id<MTLBuffer>  buffer;
+  NSUInteger     vertexCount;
+  uint64_t       revision; // Mesh3Dのrevision
+  MeshInstance3D instance;
+};
+} // namespace
 
 @interface Draw3D ()
 @end
@@ -24,14 +48,30 @@
   NSUInteger     pageIndex_;
 
   id<MTLRenderPipelineState> pipelineState_;
+  id<MTLRenderPipelineState> pipelineStateParticle_;
+  id<MTLRenderPipelineState> pipelineStateMesh_;
+  id<MTLDepthStencilState>   depthStateReadOnly_;
   id<MTLBuffer>              uniformBuffer_[3];
   id<MTLBuffer>              vertices_[3];
   id<MTLBuffer>              verticesPlane_[3];
   NSUInteger                 nbPrimitives_;
   NSUInteger                 nbPlanes_;
+  NSUInteger                 nbTranslucent_;
+  id<MTLBuffer>              particles_[3];
+  NSUInteger                 nbParticles_;
 
   SimpleLock primLock_;
   SimpleLock planeLock_;
+  SimpleLock particleLock_;
+  SimpleLock meshLock_;
+
+  std::vector<MeshDraw3D> meshDraws_;
+
+  // 半透明の三角形(描画時に奥から順に並べてverticesPlane_の後ろへ書き込む)
+  std::vector<VertexDataPrim3D> translucent_;
+  Translucent::Sorter           translucentSorter_;
+  NSUInteger                    lastTranslucentCount_;
+  double                        lastTranslucentSortTime_;
 }
 
 //
@@ -61,7 +101,28 @@
 
   pipelineState_ = [device_ newRenderPipelineStateWithDescriptor:pipelineDesc error:&error];
 
+  // mesh
+  pipelineDesc.label          = @"PipelineMesh3D";
+  pipelineDesc.vertexFunction = [library newFunctionWithName:@"meshVert3d"];
+
+  pipelineStateMesh_ = [device_ newRenderPipelineStateWithDescriptor:pipelineDesc error:&error];
+
+  // particle
+  pipelineDesc.label            = @"PipelineParticle3D";
+  pipelineDesc.vertexFunction   = [library newFunctionWithName:@"particleVert3d"];
+  pipelineDesc.fragmentFunction = [library newFunctionWithName:@"particleFrag"];
+
+  pipelineStateParticle_ = [device_ newRenderPipelineStateWithDescriptor:pipelineDesc
+                                                                   error:&error];
+
   [pipelineDesc release];
+
+  // 半透明(三角形とパーティクル)は奥行きを書き込まない
+  auto depthStateDesc                 = [[MTLDepthStencilDescriptor alloc] init];
+  depthStateDesc.depthCompareFunction = MTLCompareFunctionLess;
+  depthStateDesc.depthWriteEnabled    = NO;
+  depthStateReadOnly_ = [device_ newDepthStencilStateWithDescriptor:depthStateDesc];
+  [depthStateDesc release];
 }
 
 //
@@ -78,15 +139,22 @@
   pageIndex_    = 0;
   nbPrimitives_ = 0;
   nbPlanes_     = 0;
+  nbParticles_  = 0;
   [self initializePipeline:library];
 
+  // 書き込みはロックの外で行うので、途中で確保し直さないように最大数を取っておく
+  nbTranslucent_           = 0;
+  lastTranslucentCount_    = 0;
+  lastTranslucentSortTime_ = 0.0;
+  translucent_.resize(MaxTriangleVertices);
+
   for (int i = 0; i < 3; i++)
   {
     uniformBuffer_[i] = [device_ newBufferWithLength:sizeof(Uniforms)
                                              options:MTLResourceStorageModeShared];
-    vertices_[i]      = [device_ newBufferWithLength:sizeof(VertexDataPrim3D) * 4 * 30000
+    vertices_[i]      = [device_ newBufferWithLength:sizeof(VertexDataPrim3D) * MaxLineVertices
                                         options:MTLResourceStorageModeShared];
-    verticesPlane_[i] = [device_ newBufferWithLength:sizeof(VertexDataPrim3D) * 3 * 100000
+    verticesPlane_[i] = [device_ newBufferWithLength:sizeof(VertexDataPrim3D) * MaxTriangleVertices
                                              options:MTLResourceStorageModeShared];
   }
 
@@ -101,45 +169,83 @@
     [uniformBuffer_[i] release];
     [vertices_[i] release];
     [verticesPlane_[i] release];
+    [particles_[i] release];
   }
   [pipelineState_ release];
+  [pipelineStateParticle_ release];
+  [pipelineStateMesh_ release];
+  for (auto &draw : meshDraws_)
+  {
+    [draw.buffer release];
+  }
+  [depthStateReadOnly_ release];
   [super dealloc];
 }
 
 //
-- (void)drawLine:(simd_float3)from to:(simd_float3)to color:(simd_float4)color
+- (NSUInteger)lastTranslucentCount
 {
-  primLock_.lock();
-  auto  vtx   = vertices_[pageIndex_];
-  auto *vtx3d = (VertexDataPrim3D *)vtx.contents + nbPrimitives_;
+  return lastTranslucentCount_;
+}
 
-  nbPrimitives_ += 2;
-  primLock_.unlock();
+//
+- (double)lastTranslucentSortTime
+{
+  return lastTranslucentSortTime_;
+}
 
-  auto col16        = vcvt_f16_f32(color);
-  vtx3d[0].position = from;
-  vtx3d[0].color    = col16;
-  vtx3d[1].position = to;
-  vtx3d[1].color    = col16;
+// 線の頂点領域を確保する(足りなければnullptr)
+- (VertexDataPrim3D *)reserveLines:(NSUInteger)nbVertices
+{
+  SimpleGuard guard{primLock_};
+  if (nbPrimitives_ + nbVertices > MaxLineVertices)
+  {
+    return nullptr;
+  }
+  auto *vtx3d = (VertexDataPrim3D *)vertices_[pageIndex_].contents + nbPrimitives_;
+  nbPrimitives_ += nbVertices;
+  return vtx3d;
 }
 
-//
-- (void)drawTriangle:(simd_float3)p0 p1:(simd_float3)p1 p2:(simd_float3)p2 color:(simd_float4)color
+// 三角形の頂点領域を確保する(足りなければnullptr)
+// 半透明のものは並べ替えるまで別に取っておく。容量は不透明と合わせて数える
+- (VertexDataPrim3D *)reserveTriangles:(NSUInteger)nbVertices translucent:(BOOL)translucent
 {
-  planeLock_.lock();
-  auto  vtx   = verticesPlane_[pageIndex_];
-  auto *vtx3d = (VertexDataPrim3D *)vtx.contents + nbPlanes_;
+  SimpleGuard guard{planeLock_};
+  if (nbPlanes_ + nbTranslucent_ + nbVertices > MaxTriangleVertices)
+  {
+    return nullptr;
+  }
+  VertexDataPrim3D *vtx3d;
+  if (translucent)
+  {
+    vtx3d = translucent_.data() + nbTranslucent_;
+    nbTranslucent_ += nbVertices;
+  }
+  else
+  {
+    vtx3d = (VertexDataPrim3D *)verticesPlane_[pageIndex_].contents + nbPlanes_;
+    nbPlanes_ += nbVertices;
+  }
+  return vtx3d;
+}
 
-  nbPlanes_ += 3;
-  planeLock_.unlock();
+//
+- (void)drawLine:(simd_float3)from to:(simd_float3)to color:(simd_float4)color
+{
+  if (auto *vtx3d = [self reserveLines:2])
+  {
+    Prim3D::WriteLine(vtx3d, from, to, vcvt_f16_f32(color));
+  }
+}
 
-  auto col16        = vcvt_f16_f32(color);
-  vtx3d[0].position = p0;
-  vtx3d[0].color    = col16;
-  vtx3d[1].position = p1;
-  vtx3d[1].color    = col16;
-  vtx3d[2].position = p2;
-  vtx3d[2].color    = col16;
+//
+- (void)drawTriangle:(simd_float3)p0 p1:(simd_float3)p1 p2:(simd_float3)p2 color:(simd_float4)color
+{
+  if (auto *vtx3d = [self reserveTriangles:3 translucent:color.w < 1.0f])
+  {
+    Prim3D::WriteTriangle(vtx3d, p0, p1, p2, vcvt_f16_f32(color));
+  }
 }
 
 //
@@ -153,13 +259,153 @@
   [self drawTriangle:p3 p1:p2 p2:p0 color:color];
 }
 
+//
+- (void)drawLines:(nonnull const Line3D *)lines count:(NSUInteger)count
+{
+  Prim3D::WriteLines(
+      lines, count, [&](size_t nbVertices) { return [self reserveLines:nbVertices]; });
+}
+
+//
+- (void)drawTriangles:(nonnull const Triangle3D *)triangles
+                count:(NSUInteger)count
+               colors:(nonnull const simd_float4 *)colors
+           colorCount:(NSUInteger)colorCount
+{
+  Prim3D::WriteTriangles(triangles,
+                         count,
+                         colors,
+                         colorCount,
+                         [&](size_t nbVertices, bool translucent)
+                         { return [self reserveTriangles:nbVertices translucent:translucent]; });
+}
+
+//
+- (nonnull Mesh3D *)newMesh
+{
+  return [[Mesh3D alloc] initWithDevice:device_];
+}
+
+//
+- (void)drawMesh:(nonnull Mesh3D *)mesh transform:(simd_float4x4)model color:(simd_float4)color
+{
+  auto buffer = [mesh vertexBuffer];
+  if (buffer == nil)
+  {
+    return;
+  }
+
+  MeshDraw3D draw;
+  draw.buffer         = [buffer retain];
+  draw.vertexCount    = mesh.vertexCount;
+  draw.revision       = mesh.revision;
+  draw.instance.model = model;
+  draw.instance.color = color;
+
+  SimpleGuard guard{meshLock_};
+  meshDraws_.push_back(draw);
+}
+
+//
+- (void)drawParticles:(const Particle::System &)system
+{
+  auto count = system.size();
+  if (count == 0)
+  {
+    return;
+  }
+
+  // 書き込み中にバッファを差し替えられないようにロックしたまま書き出す
+  SimpleGuard guard{particleLock_};
+  auto        buffer = particles_[pageIndex_];
+  auto        needed = (nbParticles_ + count) * sizeof(ParticleData);
+  if (buffer.length < needed)
+  {
+    // 足りなければ大きくして作り直す(このページは描画に使われていない)
+    auto length = std::max<NSUInteger>(needed, buffer.length * 2);
+    auto grown  = [device_ newBufferWithLength:length options:MTLResourceStorageModeShared];
+    if (buffer != nil)
+    {
+      std::memcpy(grown.contents, buffer.contents, nbParticles_ * sizeof(ParticleData));
+      [buffer release];
+    }
+    grown.label            = @"Particle3D";
+    particles_[pageIndex_] = buffer = grown;
+  }
+
+  auto *dst = (Particle::Vertex *)buffer.contents + nbParticles_;
+  system.writeAll(dst);
+  nbParticles_ += count;
+}
+
+// 半透明の三角形を奥から順に並べ、不透明の後ろへ書き込む
+- (void)sortTranslucent:(nonnull CameraData *)camera
+{
+  auto start = std::chrono::steady_clock::now();
+
+  // ビュー空間のzの行
+  auto        mdlview = camera->getModelViewMatrix();
+  simd_float4 row     = simd_make_float4(
+      mdlview.columns[0][2], mdlview.columns[1][2], mdlview.columns[2][2], mdlview.columns[3][2]);
+  size_t      nbTriangles = nbTranslucent_ / 3;
+  auto       *dst         = (VertexDataPrim3D *)verticesPlane_[pageIndex_].contents + nbPlanes_;
+  translucentSorter_.sort(translucent_.data(), nbTriangles, row, dst);
+
+  lastTranslucentCount_ = nbTriangles;
+  lastTranslucentSortTime_ =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// このフレームで積んだ描画内容のハッシュ(Updateの後、render:の前に呼ぶ)
+// バッファはページ毎に替わるので中身と数で比べる
+- (uint64_t)frameHash
+{
+  FrameHash hash;
+  hash.add(nbPrimitives_);
+  hash.add(nbPlanes_);
+  hash.add(nbTranslucent_);
+  hash.add(nbParticles_);
+  hash.update(vertices_[pageIndex_].contents, nbPrimitives_ * sizeof(VertexDataPrim3D));
+  hash.update(verticesPlane_[pageIndex_].contents, nbPlanes_ * sizeof(VertexDataPrim3D));
+  hash.update(translucent_.data(), nbTranslucent_ * sizeof(VertexDataPrim3D));
+  if (nbParticles_ > 0)
+  {
+    hash.update(particles_[pageIndex_].contents, nbParticles_ * sizeof(ParticleData));
+  }
+  for (const auto &draw : meshDraws_)
+  {
+    hash.add(draw.revision);
+    hash.add(draw.instance);
+  }
+  return hash.digest();
+}
+
+// 描画せずにこのフレームの内容を捨てる(GPUに渡していないのでページは進めない)
+- (void)discardFrame
+{
+  for (auto &draw : meshDraws_)
+  {
+    [draw.buffer release];
+  }
+  meshDraws_.clear();
+  nbPrimitives_            = 0;
+  nbPlanes_                = 0;
+  nbTranslucent_           = 0;
+  nbParticles_             = 0;
+  lastTranslucentCount_    = 0;
+  lastTranslucentSortTime_ = 0.0;
+}
+
 //
 - (void)render:(nullable id<MTLRenderCommandEncoder>)renderEncoder
         camera:(nonnull CameraData *)camera;
 {
   [renderEncoder pushDebugGroup:@"Draw3D"];
 
-  if (nbPrimitives_ > 0 || nbPlanes_ > 0)
+  lastTranslucentCount_    = 0;
+  lastTranslucentSortTime_ = 0.0;
+  if (nbPrimitives_ > 0 || nbPlanes_ > 0 || !meshDraws_.empty() || nbTranslucent_ > 0 ||
+      nbParticles_ > 0)
   {
     auto uniformBuff = uniformBuffer_[pageIndex_];
     auto uniform     = (Uniforms *)uniformBuff.contents;
@@ -190,9 +436,61 @@
       [renderEncoder setFragmentBuffer:uniformBuff offset:0 atIndex:1];
       [renderEncoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:nbPlanes_];
     }
+    if (!meshDraws_.empty())
+    {
+      [renderEncoder setRenderPipelineState:pipelineStateMesh_];
+      [renderEncoder setVertexBuffer:uniformBuff offset:0 atIndex:1];
+      [renderEncoder setFragmentBuffer:uniformBuff offset:0 atIndex:1];
+      for (auto &draw : meshDraws_)
+      {
+        [renderEncoder setVertexBuffer:draw.buffer offset:0 atIndex:0];
+        [renderEncoder setVertexBytes:&draw.instance length:sizeof(MeshInstance3D) atIndex:2];
+        [renderEncoder drawPrimitives:MTLPrimitiveTypeTriangle
+                          vertexStart:0
+                          vertexCount:draw.vertexCount];
+        // エンコーダーがバッファを保持するのでここで手放してよい
+        [draw.buffer release];
+      }
+      meshDraws_.clear();
+      [renderEncoder setRenderPipelineState:pipelineState_];
+    }
+    if (nbTranslucent_ > 0)
+    {
+      [self sortTranslucent:camera];
+
+      auto vtx = verticesPlane_[pageIndex_];
+      [vtx didModifyRange:NSMakeRange(nbPlanes_ * sizeof(VertexDataPrim3D),
+                                      nbTranslucent_ * sizeof(VertexDataPrim3D))];
+      [renderEncoder setDepthStencilState:depthStateReadOnly_];
+      [renderEncoder setVertexBuffer:vtx offset:0 atIndex:0];
+      [renderEncoder setVertexBuffer:uniformBuff offset:0 atIndex:1];
+      [renderEncoder setFragmentBuffer:uniformBuff offset:0 atIndex:1];
+      [renderEncoder drawPrimitives:MTLPrimitiveTypeTriangle
+                        vertexStart:nbPlanes_
+                        vertexCount:nbTranslucent_];
+    }
+    if (nbParticles_ > 0)
+    {
+      ParticleBasis basis;
+      basis.right = camera->getViewRight();
+      basis.up    = camera->getViewUp();
+
+      auto vtx = particles_[pageIndex_];
+      [vtx didModifyRange:NSMakeRange(0, nbParticles_ * sizeof(ParticleData))];
+      [renderEncoder setRenderPipelineState:pipelineStateParticle_];
+      [renderEncoder setDepthStencilState:depthStateReadOnly_];
+      [renderEncoder setVertexBuffer:vtx offset:0 atIndex:0];
+      [renderEncoder setVertexBuffer:uniformBuff offset:0 atIndex:1];
+      [renderEncoder setVertexBytes:&basis length:sizeof(basis) atIndex:2];
+      [renderEncoder drawPrimitives:MTLPrimitiveTypeTriangle
+                        vertexStart:0
+                        vertexCount:nbParticles_ * 6];
+    }
 
-    nbPrimitives_ = 0;
-    nbPlanes_     = 0;
+    nbPrimitives_  = 0;
+    nbPlanes_      = 0;
+    nbTranslucent_ = 0;
+    nbParticles_   = 0;
   }
 
   [renderEncoder popDebugGroup];
@@ -0,0 +1,128 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "frame_arena.h"
+#include <algorithm>
+#include <array>
+
+namespace
+{
+// アリーナの識別番号(破棄されたアリーナの番号は再利用しない)
+std::atomic<uint64_t> ArenaSerial{1};
+
+// スレッド毎のスロットのキャッシュ
+struct SlotCache
+{
+  uint64_t arenaId;
+  void    *slot;
+};
+thread_local std::array<SlotCache, 8> LocalSlots{};
+thread_local size_t                   LocalSlotNext = 0;
+
+} // namespace
+
+//
+FrameArena::FrameArena(size_t chunkSize)
+    : id_(ArenaSerial++), chunkSize_(chunkSize), resource_(*this)
+{
+}
+
+//
+FrameArena::~FrameArena()
+{
+  // このスレッドのキャッシュだけは消しておく(他のスレッドは番号が一致しないので使われない)
+  for (auto &cache : LocalSlots)
+  {
+    if (cache.arenaId == id_)
+    {
+      cache = {};
+    }
+  }
+}
+
+//
+FrameArena::Slot *FrameArena::localSlot()
+{
+  for (const auto &cache : LocalSlots)
+  {
+    if (cache.arenaId == id_)
+    {
+      return static_cast<Slot *>(cache.slot);
+    }
+  }
+
+  std::lock_guard lock{mutex_};
+  auto           &slot = slotMap_[std::this_thread::get_id()];
+  if (slot == nullptr)
+  {
+    slots_.push_back(std::make_unique<Slot>());
+    slot = slots_.back().get();
+  }
+  LocalSlots[LocalSlotNext] = {id_, slot};
+  LocalSlotNext             = (LocalSlotNext + 1) % LocalSlots.size();
+  return slot;
+}
+
+//
+void *FrameArena::allocate(size_t bytes, size_t alignment)
+{
+  auto *slot = localSlot();
+  for (;;)
+  {
+    if (slot->current < slot->chunks.size())
+    {
+      auto &chunk   = slot->chunks[slot->current];
+      auto  base    = reinterpret_cast<uintptr_t>(chunk.data.get());
+      auto  aligned = (base + slot->offset + alignment - 1) & ~uintptr_t(alignment - 1);
+      if (aligned + bytes <= base + chunk.size)
+      {
+        slot->offset = aligned + bytes - base;
+        slot->used.store(slot->used.load(std::memory_order_relaxed) + bytes,
+                         std::memory_order_relaxed);
+        return reinterpret_cast<void *>(aligned);
+      }
+      // 入らなければ次のチャンクへ(残りはこのフレームでは使わない)
+      slot->current++;
+      slot->offset = 0;
+      continue;
+    }
+
+    // 前のフレームまでに確保したチャンクを使い切った時だけヒープから確保する
+    auto size = std::max(chunkSize_, bytes + alignment);
+    slot->chunks.push_back({std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+    slot->reserved.store(slot->reserved.load(std::memory_order_relaxed) + size,
+                         std::memory_order_relaxed);
+    chunkAllocations_++;
+  }
+}
+
+//
+void FrameArena::reset()
+{
+  std::lock_guard lock{mutex_};
+  size_t          used = 0;
+  for (auto &slot : slots_)
+  {
+    used += slot->used.load(std::memory_order_relaxed);
+    slot->current = 0;
+    slot->offset  = 0;
+    slot->used.store(0, std::memory_order_relaxed);
+  }
+  peakBytes_ = std::max(peakBytes_, used);
+}
+
+//
+FrameArena::Stats FrameArena::stats()
+{
+  std::lock_guard lock{mutex_};
+  Stats           result{};
+  // chunksは持ち主が伸ばしている最中かもしれないので触らない
+  for (const auto &slot : slots_)
+  {
+    result.bytesUsed += slot->used.load(std::memory_order_relaxed);
+    result.bytesReserved += slot->reserved.load(std::memory_order_relaxed);
+  }
+  result.peakBytes        = std::max(peakBytes_, result.bytesUsed);
+  result.chunkAllocations = chunkAllocations_;
+  return result;
+}
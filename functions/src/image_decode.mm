@@ -0,0 +1,65 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "image_decode.h"
+#import <CoreGraphics/CoreGraphics.h>
+#import <Foundation/Foundation.h>
+#import <ImageIO/ImageIO.h>
+#include <algorithm>
+#include <cstring>
+
+//
+bool DecodeImageFile(const char *path, uint32_t rowAlignment, ImageDownsample::Image &image)
+{
+  auto url = CFURLCreateFromFileSystemRepresentation(
+      nullptr, (const UInt8 *)path, std::strlen(path), false);
+  auto source = CGImageSourceCreateWithURL(url, nullptr);
+  CFRelease(url);
+  if (source == nullptr)
+  {
+    return false;
+  }
+  auto cgimg = CGImageSourceCreateImageAtIndex(source, 0, nullptr);
+  CFRelease(source);
+  if (cgimg == nullptr)
+  {
+    return false;
+  }
+
+  image.width       = CGImageGetWidth(cgimg);
+  image.height      = CGImageGetHeight(cgimg);
+  image.bytesPerRow = ImageDownsample::RowBytes(image.width, rowAlignment);
+  image.pixels.assign((size_t)image.bytesPerRow * image.height, 0);
+
+  auto colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+  auto ctx        = CGBitmapContextCreate(image.pixels.data(),
+                                   image.width,
+                                   image.height,
+                                   8,
+                                   image.bytesPerRow,
+                                   colorSpace,
+                                   kCGImageAlphaPremultipliedLast);
+  CGContextSetBlendMode(ctx, kCGBlendModeCopy);
+  CGContextDrawImage(ctx, CGRectMake(0, 0, image.width, image.height), cgimg);
+  CFRelease(ctx);
+  CGColorSpaceRelease(colorSpace);
+  CGImageRelease(cgimg);
+
+  // シェーダーはストレートアルファを前提にしている
+  for (uint32_t y = 0; y < image.height; y++)
+  {
+    auto *row = image.pixels.data() + (size_t)y * image.bytesPerRow;
+    for (uint32_t x = 0; x < image.width; x++)
+    {
+      auto *px = row + x * 4;
+      if (px[3] != 0 && px[3] != 255)
+      {
+        for (int c = 0; c < 3; c++)
+        {
+          px[c] = std::min(255, (px[c] * 255 + px[3] / 2) / px[3]);
+        }
+      }
+    }
+  }
+  return true;
+}
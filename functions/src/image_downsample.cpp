@@ -0,0 +1,257 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "image_downsample.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace ImageDownsample
+{
+namespace
+{
+// 1スレッドあたりの最小ピクセル数
+constexpr size_t MinPixelsPerTask = 16 * 1024;
+constexpr int    LinearSteps      = 4096;
+
+struct SRGBTable
+{
+  std::array<float, 256>           toLinear;
+  std::array<uint8_t, LinearSteps> toSRGB;
+
+  SRGBTable()
+  {
+    for (int i = 0; i < 256; i++)
+    {
+      float c     = i / 255.0f;
+      toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+    for (int i = 0; i < LinearSteps; i++)
+    {
+      float l   = i / float(LinearSteps - 1);
+      float c   = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+      toSRGB[i] = uint8_t(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+    }
+  }
+};
+
+const SRGBTable &GetSRGBTable()
+{
+  static const SRGBTable table;
+  return table;
+}
+
+//
+// 2x2を1ピクセルに。色はアルファで重み付けする(透明なピクセルの色が混ざらないように)
+void HalvePixelLinear(const uint8_t *p0, const uint8_t *p1, const uint8_t *p2, const uint8_t *p3,
+                      uint8_t *out)
+{
+  int a0    = p0[3];
+  int a1    = p1[3];
+  int a2    = p2[3];
+  int a3    = p3[3];
+  int alpha = a0 + a1 + a2 + a3;
+  if (alpha == 0 || (a0 == a1 && a0 == a2 && a0 == a3))
+  {
+    // 重みが全部同じなら単純な平均と同じ
+    for (int c = 0; c < 3; c++)
+    {
+      int sum = p0[c] + p1[c] + p2[c] + p3[c];
+      out[c]  = uint8_t((sum + 2) >> 2);
+    }
+  }
+  else
+  {
+    for (int c = 0; c < 3; c++)
+    {
+      int sum = p0[c] * a0 + p1[c] * a1 + p2[c] * a2 + p3[c] * a3;
+      out[c]  = uint8_t((sum + alpha / 2) / alpha);
+    }
+  }
+  out[3] = uint8_t((alpha + 2) >> 2);
+}
+
+//
+void HalveRowsLinear(const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight,
+                     uint32_t srcBytesPerRow, uint8_t *dst, uint32_t dstWidth,
+                     uint32_t dstBytesPerRow, size_t yBegin, size_t yEnd)
+{
+  for (size_t y = yBegin; y < yEnd; y++)
+  {
+    auto *row0 = src + std::min<size_t>(y * 2, srcHeight - 1) * srcBytesPerRow;
+    auto *row1 = src + std::min<size_t>(y * 2 + 1, srcHeight - 1) * srcBytesPerRow;
+    auto *out  = dst + y * dstBytesPerRow;
+
+    uint32_t x = 0;
+#if defined(__ARM_NEON)
+    // 4ピクセルずつ: 偶数/奇数ピクセルに分けて読み込み、縦横4つの和を丸めて1/4
+    // (16ピクセル全部が不透明な時だけ。それ以外は重み付きで1ピクセルずつ)
+    for (; x + 4 <= dstWidth && (x + 4) * 2 <= srcWidth; x += 4)
+    {
+      auto a = vld2q_u32(reinterpret_cast<const uint32_t *>(row0 + x * 8));
+      auto b = vld2q_u32(reinterpret_cast<const uint32_t *>(row1 + x * 8));
+      if (vminvq_u32(vandq_u32(vandq_u32(a.val[0], a.val[1]), vandq_u32(b.val[0], b.val[1]))) <
+          0xff000000u)
+      {
+        for (uint32_t i = x; i < x + 4; i++)
+        {
+          HalvePixelLinear(row0 + i * 8, row0 + i * 8 + 4, row1 + i * 8, row1 + i * 8 + 4,
+                           out + i * 4);
+        }
+        continue;
+      }
+      auto a0 = vreinterpretq_u8_u32(a.val[0]);
+      auto a1 = vreinterpretq_u8_u32(a.val[1]);
+      auto b0 = vreinterpretq_u8_u32(b.val[0]);
+      auto b1 = vreinterpretq_u8_u32(b.val[1]);
+      auto lo = vaddl_u8(vget_low_u8(a0), vget_low_u8(a1));
+      auto hi = vaddl_u8(vget_high_u8(a0), vget_high_u8(a1));
+      lo      = vaddw_u8(vaddw_u8(lo, vget_low_u8(b0)), vget_low_u8(b1));
+      hi      = vaddw_u8(vaddw_u8(hi, vget_high_u8(b0)), vget_high_u8(b1));
+      vst1q_u8(out + x * 4, vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+    }
+#endif
+    for (; x < dstWidth; x++)
+    {
+      auto sx0 = std::min(x * 2, srcWidth - 1) * 4;
+      auto sx1 = std::min(x * 2 + 1, srcWidth - 1) * 4;
+      HalvePixelLinear(row0 + sx0, row0 + sx1, row1 + sx0, row1 + sx1, out + x * 4);
+    }
+  }
+}
+
+//
+void HalveRowsSRGB(const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight,
+                   uint32_t srcBytesPerRow, uint8_t *dst, uint32_t dstWidth,
+                   uint32_t dstBytesPerRow, size_t yBegin, size_t yEnd)
+{
+  const auto &table = GetSRGBTable();
+  for (size_t y = yBegin; y < yEnd; y++)
+  {
+    auto *row0 = src + std::min<size_t>(y * 2, srcHeight - 1) * srcBytesPerRow;
+    auto *row1 = src + std::min<size_t>(y * 2 + 1, srcHeight - 1) * srcBytesPerRow;
+    auto *out  = dst + y * dstBytesPerRow;
+    for (uint32_t x = 0; x < dstWidth; x++)
+    {
+      const uint8_t *p[4] = {row0 + std::min(x * 2, srcWidth - 1) * 4,
+                             row0 + std::min(x * 2 + 1, srcWidth - 1) * 4,
+                             row1 + std::min(x * 2, srcWidth - 1) * 4,
+                             row1 + std::min(x * 2 + 1, srcWidth - 1) * 4};
+      // リニア値をアルファで重み付けする(全部透明なら単純な平均)
+      int   alpha  = p[0][3] + p[1][3] + p[2][3] + p[3][3];
+      float weight[4];
+      float scale;
+      if (alpha == 0)
+      {
+        std::fill_n(weight, 4, 1.0f);
+        scale = 0.25f;
+      }
+      else
+      {
+        for (int i = 0; i < 4; i++)
+        {
+          weight[i] = p[i][3];
+        }
+        scale = 1.0f / alpha;
+      }
+      for (int c = 0; c < 3; c++)
+      {
+        float sum = table.toLinear[p[0][c]] * weight[0] + table.toLinear[p[1][c]] * weight[1] +
+                    table.toLinear[p[2][c]] * weight[2] + table.toLinear[p[3][c]] * weight[3];
+        out[x * 4 + c] = table.toSRGB[int(sum * scale * (LinearSteps - 1) + 0.5f)];
+      }
+      out[x * 4 + 3] = uint8_t((alpha + 2) >> 2);
+    }
+  }
+}
+
+} // namespace
+
+//
+uint32_t MipLevelCount(uint32_t width, uint32_t height)
+{
+  uint32_t levels = 1;
+  auto     size   = std::max(width, height);
+  while (size > 1)
+  {
+    size >>= 1;
+    levels++;
+  }
+  return levels;
+}
+
+//
+uint32_t RowBytes(uint32_t width, uint32_t alignment)
+{
+  return (width * 4 + alignment - 1) / alignment * alignment;
+}
+
+//
+void HalveRGBA8(const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight, uint32_t srcBytesPerRow,
+                uint8_t *dst, uint32_t dstBytesPerRow, bool srgb)
+{
+  auto dstWidth  = std::max(srcWidth / 2, 1u);
+  auto dstHeight = std::max(srcHeight / 2, 1u);
+  auto grain     = std::max<size_t>(MinPixelsPerTask / dstWidth, 1);
+  ParallelFor(dstHeight,
+              grain,
+              [&](size_t yBegin, size_t yEnd)
+              {
+                if (srgb)
+                {
+                  HalveRowsSRGB(src,
+                                srcWidth,
+                                srcHeight,
+                                srcBytesPerRow,
+                                dst,
+                                dstWidth,
+                                dstBytesPerRow,
+                                yBegin,
+                                yEnd);
+                }
+                else
+                {
+                  HalveRowsLinear(src,
+                                  srcWidth,
+                                  srcHeight,
+                                  srcBytesPerRow,
+                                  dst,
+                                  dstWidth,
+                                  dstBytesPerRow,
+                                  yBegin,
+                                  yEnd);
+                }
+              });
+}
+
+//
+std::vector<Image> BuildMipChain(const uint8_t *src, uint32_t width, uint32_t height,
+                                 uint32_t bytesPerRow, bool srgb, uint32_t rowAlignment)
+{
+  std::vector<Image> levels;
+  auto               count = MipLevelCount(width, height);
+  levels.reserve(count - 1);
+  for (uint32_t level = 1; level < count; level++)
+  {
+    Image image;
+    image.width       = std::max(width / 2, 1u);
+    image.height      = std::max(height / 2, 1u);
+    image.bytesPerRow = RowBytes(image.width, rowAlignment);
+    image.pixels.resize((size_t)image.bytesPerRow * image.height);
+    HalveRGBA8(src, width, height, bytesPerRow, image.pixels.data(), image.bytesPerRow, srgb);
+
+    levels.push_back(std::move(image));
+    const auto &last = levels.back();
+    src              = last.pixels.data();
+    width            = last.width;
+    height           = last.height;
+    bytesPerRow      = last.bytesPerRow;
+  }
+  return levels;
+}
+
+} // namespace ImageDownsample
@@ -0,0 +1,371 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "image_filter.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace ImageFilter
+{
+namespace
+{
+// 1タスクあたりの最小ピクセル数
+constexpr size_t MinPixelsPerTask = 8 * 1024;
+
+// GCC/Clang共通のベクタ拡張
+typedef float Vec4 __attribute__((vector_size(16)));
+
+inline Vec4 Load4(const float *ptr)
+{
+  Vec4 v;
+  std::memcpy(&v, ptr, sizeof(v));
+  return v;
+}
+inline void Store4(float *ptr, Vec4 v) { std::memcpy(ptr, &v, sizeof(v)); }
+inline Vec4 Splat(float v) { return Vec4{v, v, v, v}; }
+inline Vec4 Clamp01(Vec4 v)
+{
+  Vec4 zero = Splat(0.0f);
+  Vec4 one  = Splat(1.0f);
+  v         = v < zero ? zero : v;
+  return v > one ? one : v;
+}
+inline float Luminance(Vec4 c) { return c[0] * 0.2126f + c[1] * 0.7152f + c[2] * 0.0722f; }
+
+// sRGB <-> リニア
+// 戻す時は隣り合う値の中点と比べるので、フィルタを掛けなければ元の値に戻る
+struct SRGBTable
+{
+  std::array<float, 256> toLinear;
+  std::array<float, 255> midpoints;
+
+  SRGBTable()
+  {
+    for (int i = 0; i < 256; i++)
+    {
+      float c     = i / 255.0f;
+      toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+    for (int i = 0; i < 255; i++)
+    {
+      midpoints[i] = (toLinear[i] + toLinear[i + 1]) * 0.5f;
+    }
+  }
+
+  uint8_t encode(float linear) const
+  {
+    return uint8_t(std::upper_bound(midpoints.begin(), midpoints.end(), linear) -
+                   midpoints.begin());
+  }
+};
+
+const SRGBTable &GetSRGBTable()
+{
+  static const SRGBTable table;
+  return table;
+}
+
+//
+template <class Func>
+void ForEachRows(const ImageF &img, Func &&func)
+{
+  auto grain = std::max<size_t>(MinPixelsPerTask / std::max(img.width, 1u), 1);
+  ParallelFor(img.height, grain, std::forward<Func>(func));
+}
+
+// 画素ごとの処理
+template <class Func>
+void PointFilter(const ImageF &src, ImageF &dst, Func &&func)
+{
+  dst.resize(src.width, src.height);
+  ForEachRows(src,
+              [&](size_t yBegin, size_t yEnd)
+              {
+                const float *in  = src.pixels.data() + yBegin * src.width * 4;
+                float       *out = dst.pixels.data() + yBegin * src.width * 4;
+                size_t       n   = (yEnd - yBegin) * src.width;
+                for (size_t i = 0; i < n; i++)
+                {
+                  Store4(out + i * 4, Clamp01(func(Load4(in + i * 4))));
+                }
+              });
+}
+
+// 分離可能な畳み込み(横→縦)。weightsは中心から片側(radius+1個)
+void SeparableFilter(const ImageF &src, ImageF &dst, const std::vector<float> &weights)
+{
+  int    radius = int(weights.size()) - 1;
+  int    width  = src.width;
+  int    height = src.height;
+  ImageF temp;
+  temp.resize(width, height);
+  dst.resize(width, height);
+
+  ForEachRows(src,
+              [&](size_t yBegin, size_t yEnd)
+              {
+                for (size_t y = yBegin; y < yEnd; y++)
+                {
+                  const float *in  = src.pixels.data() + y * width * 4;
+                  float       *out = temp.pixels.data() + y * width * 4;
+                  for (int x = 0; x < width; x++)
+                  {
+                    Vec4 sum = Load4(in + x * 4) * weights[0];
+                    for (int k = 1; k <= radius; k++)
+                    {
+                      int x0 = std::max(x - k, 0);
+                      int x1 = std::min(x + k, width - 1);
+                      sum += (Load4(in + x0 * 4) + Load4(in + x1 * 4)) * weights[k];
+                    }
+                    Store4(out + x * 4, sum);
+                  }
+                }
+              });
+
+  ForEachRows(src,
+              [&](size_t yBegin, size_t yEnd)
+              {
+                for (int y = int(yBegin); y < int(yEnd); y++)
+                {
+                  float *out = dst.pixels.data() + (size_t)y * width * 4;
+                  for (int x = 0; x < width; x++)
+                  {
+                    const float *col = temp.pixels.data() + x * 4;
+                    Vec4         sum = Load4(col + (size_t)y * width * 4) * weights[0];
+                    for (int k = 1; k <= radius; k++)
+                    {
+                      int y0 = std::max(y - k, 0);
+                      int y1 = std::min(y + k, height - 1);
+                      sum += (Load4(col + (size_t)y0 * width * 4) +
+                              Load4(col + (size_t)y1 * width * 4)) *
+                             weights[k];
+                    }
+                    Store4(out + x * 4, sum);
+                  }
+                }
+              });
+}
+
+} // namespace
+
+//
+// ColorMatrix
+//
+ColorMatrix::ColorMatrix()
+{
+  std::fill(std::begin(matrix_), std::end(matrix_), 0.0f);
+  matrix_[0] = matrix_[6] = matrix_[12] = matrix_[18] = 1.0f;
+}
+
+void ColorMatrix::setMatrix(const float (&matrix)[20])
+{
+  std::copy(std::begin(matrix), std::end(matrix), matrix_);
+  touch();
+}
+
+void ColorMatrix::apply(const ImageF &src, ImageF &dst) const
+{
+  // 列ベクトルにしておき、出力 = Σ col[i] * in[i] + bias
+  Vec4 col[5];
+  for (int c = 0; c < 5; c++)
+  {
+    col[c] = Vec4{matrix_[c], matrix_[5 + c], matrix_[10 + c], matrix_[15 + c]};
+  }
+  PointFilter(src,
+              dst,
+              [&](Vec4 in)
+              { return col[0] * in[0] + col[1] * in[1] + col[2] * in[2] + col[3] * in[3] + col[4]; });
+}
+
+//
+// BoxBlur
+//
+void BoxBlur::setRadius(int radius)
+{
+  radius_ = radius;
+  touch();
+}
+
+void BoxBlur::apply(const ImageF &src, ImageF &dst) const
+{
+  int                radius = std::max(radius_, 0);
+  std::vector<float> weights(radius + 1, 1.0f / float(radius * 2 + 1));
+  SeparableFilter(src, dst, weights);
+}
+
+//
+// GaussianBlur
+//
+void GaussianBlur::setSigma(float sigma)
+{
+  sigma_ = sigma;
+  touch();
+}
+
+void GaussianBlur::apply(const ImageF &src, ImageF &dst) const
+{
+  if (sigma_ <= 0.0f)
+  {
+    dst = src;
+    return;
+  }
+
+  int                radius = int(std::ceil(sigma_ * 3.0f));
+  std::vector<float> weights(radius + 1);
+  float              total = 0.0f;
+  for (int k = 0; k <= radius; k++)
+  {
+    weights[k] = std::exp(-(k * k) / (2.0f * sigma_ * sigma_));
+    total += k == 0 ? weights[k] : weights[k] * 2.0f;
+  }
+  for (auto &w : weights)
+  {
+    w /= total;
+  }
+  SeparableFilter(src, dst, weights);
+}
+
+//
+// Threshold
+//
+void Threshold::setLevel(float level)
+{
+  level_ = level;
+  touch();
+}
+
+void Threshold::apply(const ImageF &src, ImageF &dst) const
+{
+  PointFilter(src,
+              dst,
+              [&](Vec4 in)
+              {
+                float v = Luminance(in) >= level_ ? 1.0f : 0.0f;
+                return Vec4{v, v, v, in[3]};
+              });
+}
+
+//
+// Tint
+//
+Tint::Tint(float red, float green, float blue, float amount)
+    : color_{red, green, blue}, amount_(amount)
+{
+}
+
+void Tint::setColor(float red, float green, float blue, float amount)
+{
+  color_[0] = red;
+  color_[1] = green;
+  color_[2] = blue;
+  amount_   = amount;
+  touch();
+}
+
+void Tint::apply(const ImageF &src, ImageF &dst) const
+{
+  Vec4 tint   = Vec4{color_[0], color_[1], color_[2], 1.0f};
+  Vec4 amount = Vec4{amount_, amount_, amount_, 0.0f};
+  PointFilter(src,
+              dst,
+              [&](Vec4 in)
+              {
+                Vec4 tinted = tint * Luminance(in);
+                tinted[3]   = in[3];
+                return in + (tinted - in) * amount;
+              });
+}
+
+//
+// Graph
+//
+void Graph::setSource(const uint8_t *rgba, uint32_t width, uint32_t height, uint32_t bytesPerRow,
+                      bool srgb)
+{
+  const auto &table = GetSRGBTable();
+  source_.resize(width, height);
+  for (uint32_t y = 0; y < height; y++)
+  {
+    const uint8_t *in  = rgba + (size_t)y * bytesPerRow;
+    float         *out = source_.pixels.data() + (size_t)y * width * 4;
+    for (uint32_t i = 0; i < width * 4; i++)
+    {
+      out[i] = srgb && (i & 3) != 3 ? table.toLinear[in[i]] : in[i] * (1.0f / 255.0f);
+    }
+  }
+  srgb_ = srgb;
+  sourceVersion_++;
+}
+
+//
+void Graph::clear()
+{
+  nodes_.clear();
+  stages_.clear();
+  stamps_.clear();
+}
+
+//
+bool Graph::isDirty() const
+{
+  if (builtSource_ != sourceVersion_ || stamps_.size() != nodes_.size() ||
+      builtCount_ != nodes_.size())
+  {
+    return true;
+  }
+  for (size_t i = 0; i < nodes_.size(); i++)
+  {
+    if (stamps_[i] != nodes_[i]->version())
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//
+bool Graph::process()
+{
+  // 再計算が必要な最初の段
+  size_t first = builtSource_ != sourceVersion_ ? 0 : std::min(stamps_.size(), nodes_.size());
+  for (size_t i = 0; i < first; i++)
+  {
+    if (stamps_[i] != nodes_[i]->version())
+    {
+      first = i;
+      break;
+    }
+  }
+  // clear()で段が減った時も出力を作り直す
+  if (first == nodes_.size() && builtSource_ == sourceVersion_ &&
+      stamps_.size() == nodes_.size() && builtCount_ == nodes_.size())
+  {
+    return false;
+  }
+
+  stages_.resize(nodes_.size());
+  stamps_.resize(nodes_.size());
+  for (size_t i = first; i < nodes_.size(); i++)
+  {
+    const auto &input = i == 0 ? source_ : stages_[i - 1];
+    nodes_[i]->apply(input, stages_[i]);
+    stamps_[i] = nodes_[i]->version();
+  }
+  builtSource_ = sourceVersion_;
+  builtCount_  = nodes_.size();
+
+  const auto &result = nodes_.empty() ? source_ : stages_.back();
+  const auto &table  = GetSRGBTable();
+  output_.resize(result.pixels.size());
+  for (size_t i = 0; i < result.pixels.size(); i++)
+  {
+    auto value = std::clamp(result.pixels[i], 0.0f, 1.0f);
+    output_[i] = srgb_ && (i & 3) != 3 ? table.encode(value) : uint8_t(value * 255.0f + 0.5f);
+  }
+  return true;
+}
+
+} // namespace ImageFilter
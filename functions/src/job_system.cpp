@@ -0,0 +1,463 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "job_system.h"
+
+namespace
+{
+// 実行中のワーカー
+thread_local JobSystem *CurrentSystem = nullptr;
+thread_local size_t     CurrentIndex  = 0;
+
+// 空回りしてから眠るまでの回数
+constexpr int SpinCount = 64;
+// スレッド毎に取っておくジョブの数
+constexpr size_t MaxPooledJobs = 1024;
+
+} // namespace
+
+//
+// Chase-Lev deque
+//
+JobSystem::WorkQueue::WorkQueue() : buffer_(new std::atomic<Job *>[Capacity]) {}
+
+//
+bool JobSystem::WorkQueue::push(Job *job)
+{
+  auto b = bottom_.load(std::memory_order_relaxed);
+  auto t = top_.load(std::memory_order_acquire);
+  if (b - t >= Capacity)
+  {
+    return false;
+  }
+  buffer_[b & (Capacity - 1)].store(job, std::memory_order_relaxed);
+  bottom_.store(b + 1, std::memory_order_release);
+  return true;
+}
+
+//
+JobSystem::Job *JobSystem::WorkQueue::pop()
+{
+  auto b = bottom_.load(std::memory_order_relaxed) - 1;
+  bottom_.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto t = top_.load(std::memory_order_relaxed);
+  if (t > b)
+  {
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  auto *job = buffer_[b & (Capacity - 1)].load(std::memory_order_relaxed);
+  if (t == b)
+  {
+    // 最後の1つはstealと取り合う
+    if (!top_.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+      job = nullptr;
+    }
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+  return job;
+}
+
+//
+JobSystem::Job *JobSystem::WorkQueue::steal()
+{
+  auto t = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto b = bottom_.load(std::memory_order_acquire);
+  if (t >= b)
+  {
+    return nullptr;
+  }
+
+  auto *job = buffer_[t & (Capacity - 1)].load(std::memory_order_relaxed);
+  if (!top_.compare_exchange_strong(
+          t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+  {
+    return nullptr;
+  }
+  return job;
+}
+
+//
+bool JobSystem::WorkQueue::empty() const
+{
+  return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+}
+
+//
+// TaskGroup
+//
+JobSystem::TaskGroup::TaskGroup(JobSystem &system) : system_(system)
+{
+  // 閉じるまでの参照(wait()かthen()で外す)
+  counter_.pending_.store(1, std::memory_order_relaxed);
+}
+
+//
+JobSystem::TaskGroup::~TaskGroup() { wait(); }
+
+//
+void JobSystem::TaskGroup::run(std::function<void()> func)
+{
+  system_.run(counter_, std::move(func));
+}
+
+//
+void JobSystem::TaskGroup::then(std::function<void()> func)
+{
+  if (sealed_)
+  {
+    return;
+  }
+  // 印を立てると同時に閉じる。既に全て終わっていればここで投入する
+  auto *job              = allocateJob();
+  job->func              = std::move(func);
+  job->counter           = &counter_;
+  counter_.continuation_ = job;
+  sealed_                = true;
+  auto prev = counter_.pending_.fetch_add(Counter::ContinuationFlag - 1, std::memory_order_acq_rel);
+  if (prev == 1)
+  {
+    system_.launchContinuation(counter_);
+  }
+}
+
+//
+void JobSystem::TaskGroup::wait()
+{
+  if (!sealed_)
+  {
+    sealed_ = true;
+    system_.finish(counter_);
+  }
+  system_.wait(counter_);
+}
+
+//
+// JobSystem
+//
+JobSystem::JobSystem(size_t workers)
+{
+  if (workers == 0)
+  {
+    workers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+  }
+  for (size_t i = 0; i < workers; i++)
+  {
+    queues_.push_back(std::make_unique<WorkQueue>());
+  }
+  threads_.reserve(workers);
+  for (size_t i = 0; i < workers; i++)
+  {
+    threads_.emplace_back([this, i] { workerMain(i); });
+  }
+}
+
+//
+JobSystem::~JobSystem()
+{
+  {
+    std::lock_guard lock{sleepMutex_};
+    stop_.store(true);
+  }
+  sleepCond_.notify_all();
+  for (auto &th : threads_)
+  {
+    th.join();
+  }
+}
+
+//
+JobSystem &JobSystem::Default()
+{
+  static JobSystem instance;
+  return instance;
+}
+
+//
+std::vector<JobSystem::Job *> &JobSystem::jobPool()
+{
+  // スレッド毎に使い回す(別のスレッドで解放されたものはそちらのスレッドに溜まる)
+  struct Pool
+  {
+    std::vector<Job *> jobs;
+    ~Pool()
+    {
+      for (auto *job : jobs)
+      {
+        delete job;
+      }
+    }
+  };
+  thread_local Pool pool;
+  return pool.jobs;
+}
+
+//
+JobSystem::Job *JobSystem::allocateJob()
+{
+  auto &pool = jobPool();
+  if (pool.empty())
+  {
+    return new Job;
+  }
+  auto *job = pool.back();
+  pool.pop_back();
+  return job;
+}
+
+//
+void JobSystem::releaseJob(Job *job)
+{
+  auto &pool = jobPool();
+  if (pool.size() >= MaxPooledJobs)
+  {
+    delete job;
+    return;
+  }
+  job->entry   = nullptr;
+  job->data    = nullptr;
+  job->func    = nullptr;
+  job->counter = nullptr;
+  pool.push_back(job);
+}
+
+//
+void JobSystem::workerMain(size_t index)
+{
+  CurrentSystem = this;
+  CurrentIndex  = index;
+
+  while (!stop_.load(std::memory_order_relaxed))
+  {
+    if (auto *job = take())
+    {
+      execute(job);
+      continue;
+    }
+
+    bool found = false;
+    for (int i = 0; i < SpinCount && !found; i++)
+    {
+      std::this_thread::yield();
+      found = queued_.load(std::memory_order_relaxed) > 0;
+    }
+    if (found)
+    {
+      continue;
+    }
+
+    std::unique_lock lock{sleepMutex_};
+    sleepers_.fetch_add(1);
+    sleepCond_.wait(lock, [this] { return queued_.load() > 0 || stop_.load(); });
+    sleepers_.fetch_sub(1);
+  }
+}
+
+//
+void JobSystem::run(Counter &counter, std::function<void()> func)
+{
+  auto *job    = allocateJob();
+  job->func    = std::move(func);
+  job->counter = &counter;
+  counter.pending_.fetch_add(1, std::memory_order_relaxed);
+  submit(job);
+}
+
+//
+void JobSystem::submit(Job *job)
+{
+  if (CurrentSystem == this)
+  {
+    if (!queues_[CurrentIndex]->push(job))
+    {
+      // 一杯なのでその場で実行する
+      inlined_.fetch_add(1, std::memory_order_relaxed);
+      execute(job);
+      return;
+    }
+  }
+  else if (threads_.empty())
+  {
+    execute(job);
+    return;
+  }
+  else
+  {
+    std::lock_guard lock{injectMutex_};
+    injected_.push_back(job);
+    injectedCount_.fetch_add(1, std::memory_order_release);
+  }
+
+  queued_.fetch_add(1);
+  if (sleepers_.load() > 0)
+  {
+    std::lock_guard lock{sleepMutex_};
+    sleepCond_.notify_one();
+  }
+}
+
+//
+void JobSystem::execute(Job *job)
+{
+  if (job->entry != nullptr)
+  {
+    job->entry(*job);
+  }
+  else
+  {
+    job->func();
+  }
+  auto *counter = job->counter;
+  releaseJob(job);
+  executed_.fetch_add(1, std::memory_order_relaxed);
+  if (counter != nullptr)
+  {
+    finish(*counter);
+  }
+}
+
+//
+void JobSystem::finish(Counter &counter)
+{
+  // 減らした後は待っている側がcounterを破棄するかもしれないので、印が残っている時だけ触る
+  auto prev = counter.pending_.fetch_sub(1, std::memory_order_acq_rel);
+  if (prev == Counter::ContinuationFlag + 1)
+  {
+    launchContinuation(counter);
+  }
+}
+
+//
+void JobSystem::launchContinuation(Counter &counter)
+{
+  // 印を続きのジョブ1つ分に置き換えて投入する
+  auto *job             = counter.continuation_;
+  counter.continuation_ = nullptr;
+  counter.pending_.fetch_sub(Counter::ContinuationFlag - 1, std::memory_order_relaxed);
+  submit(job);
+}
+
+//
+JobSystem::Job *JobSystem::take()
+{
+  Job *job = nullptr;
+  if (CurrentSystem == this)
+  {
+    job = queues_[CurrentIndex]->pop();
+  }
+  if (job == nullptr && injectedCount_.load(std::memory_order_acquire) > 0)
+  {
+    std::lock_guard lock{injectMutex_};
+    if (!injected_.empty())
+    {
+      job = injected_.front();
+      injected_.pop_front();
+      injectedCount_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+  if (job == nullptr && !queues_.empty())
+  {
+    // 盗む相手は順に回す
+    size_t n     = queues_.size();
+    size_t start = CurrentSystem == this ? CurrentIndex + 1 : 0;
+    for (size_t i = 0; i < n && job == nullptr; i++)
+    {
+      size_t victim = (start + i) % n;
+      if (CurrentSystem == this && victim == CurrentIndex)
+      {
+        continue;
+      }
+      if ((job = queues_[victim]->steal()) != nullptr)
+      {
+        stolen_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+  if (job != nullptr)
+  {
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  return job;
+}
+
+//
+void JobSystem::wait(Counter &counter)
+{
+  while (!counter.done())
+  {
+    if (auto *job = take())
+    {
+      execute(job);
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+//
+bool JobSystem::localQueueEmpty()
+{
+  if (CurrentSystem == this)
+  {
+    return queues_[CurrentIndex]->empty();
+  }
+  return injectedCount_.load(std::memory_order_relaxed) == 0;
+}
+
+//
+void JobSystem::rangeEntry(Job &job)
+{
+  auto &ctx = *static_cast<RangeContext *>(job.data);
+  ctx.system->splitRange(ctx, job.begin, job.end);
+}
+
+//
+void JobSystem::splitRange(RangeContext &ctx, size_t begin, size_t end)
+{
+  while (begin < end)
+  {
+    // 自分のキューが空(=盗まれ済みか誰も待っていない)なら残りの後半を切り出す
+    if (end - begin > ctx.chunk * 2 && localQueueEmpty())
+    {
+      size_t mid   = begin + (end - begin) / 2;
+      auto  *job   = allocateJob();
+      job->entry   = &JobSystem::rangeEntry;
+      job->data    = &ctx;
+      job->begin   = mid;
+      job->end     = end;
+      job->counter = &ctx.counter;
+      ctx.counter.pending_.fetch_add(1, std::memory_order_relaxed);
+      submit(job);
+      end = mid;
+      continue;
+    }
+    size_t next = std::min(begin + ctx.chunk, end);
+    ctx.call(ctx.func, begin, next);
+    begin = next;
+  }
+}
+
+//
+void JobSystem::parallelForImpl(size_t count, size_t chunk, void (*call)(void *, size_t, size_t),
+                                void *func)
+{
+  RangeContext ctx{this, call, func, chunk, {}};
+  splitRange(ctx, 0, count);
+  wait(ctx.counter);
+}
+
+//
+void JobSystem::endFrame()
+{
+  wait(frameCounter_);
+  lastFrame_.executed = executed_.exchange(0, std::memory_order_relaxed);
+  lastFrame_.stolen   = stolen_.exchange(0, std::memory_order_relaxed);
+  lastFrame_.inlined  = inlined_.exchange(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,108 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#import "mesh3d.h"
+#include "shader_def.h"
+#include <arm_neon.h>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+// バッファを作り直す度に振る(全てのメッシュで一意)
+std::atomic<uint64_t> NextRevision{1};
+} // namespace
+
+@implementation Mesh3D
+{
+  id<MTLDevice>                 device_;
+  id<MTLBuffer>                 buffer_;
+  std::vector<VertexDataPrim3D> vertices_;
+  uint64_t                      revision_;
+  BOOL                          dirty_;
+}
+
+//
+- (nonnull instancetype)initWithDevice:(nonnull id<MTLDevice>)device
+{
+  self = [super init];
+  if (self != nil)
+  {
+    device_   = [device retain];
+    buffer_   = nil;
+    revision_ = 0;
+    dirty_    = NO;
+  }
+  return self;
+}
+
+//
+- (void)dealloc
+{
+  [buffer_ release];
+  [device_ release];
+  [super dealloc];
+}
+
+- (NSUInteger)vertexCount
+{
+  return vertices_.size();
+}
+
+- (uint64_t)revision
+{
+  return revision_;
+}
+
+//
+- (void)clear
+{
+  vertices_.clear();
+  dirty_ = YES;
+}
+
+//
+- (void)drawTriangle:(simd_float3)p0 p1:(simd_float3)p1 p2:(simd_float3)p2 color:(simd_float4)color
+{
+  auto col16 = vcvt_f16_f32(color);
+  vertices_.push_back({p0, col16});
+  vertices_.push_back({p1, col16});
+  vertices_.push_back({p2, col16});
+  dirty_ = YES;
+}
+
+//
+- (void)drawPlane:(simd_float3)p0
+               p1:(simd_float3)p1
+               p2:(simd_float3)p2
+               p3:(simd_float3)p3
+            color:(simd_float4)color
+{
+  // Draw3Dと同じ分割
+  [self drawTriangle:p2 p1:p1 p2:p0 color:color];
+  [self drawTriangle:p3 p1:p2 p2:p0 color:color];
+}
+
+//
+- (nullable id<MTLBuffer>)vertexBuffer
+{
+  if (dirty_)
+  {
+    // 描画中のフレームが古いバッファを参照していることがあるので上書きせずに作り直す
+    [buffer_ release];
+    buffer_   = nil;
+    dirty_    = NO;
+    revision_ = NextRevision.fetch_add(1, std::memory_order_relaxed);
+    if (!vertices_.empty())
+    {
+      auto size = vertices_.size() * sizeof(VertexDataPrim3D);
+      buffer_   = [device_ newBufferWithLength:size options:MTLResourceStorageModeShared];
+      std::memcpy(buffer_.contents, vertices_.data(), size);
+      buffer_.label = @"Mesh3D";
+    }
+  }
+  return buffer_;
+}
+
+@end
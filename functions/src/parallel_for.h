@@ -0,0 +1,18 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "job_system.h"
+#include <cstddef>
+#include <utility>
+
+//
+// [0, count)をgrain以上の塊に分けて並列に処理する
+// func(begin, end)
+//
+template <class Func>
+void ParallelFor(size_t count, size_t grain, Func &&func)
+{
+  JobSystem::Default().parallelFor(count, grain, std::forward<Func>(func));
+}
@@ -0,0 +1,256 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "particle_system.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Particle
+{
+namespace
+{
+// 1チャンクの粒子数(4の倍数)
+constexpr size_t ChunkSize = 16 * 1024;
+
+inline size_t RoundUp4(size_t n) { return (n + 3) & ~size_t(3); }
+
+// 4粒子ずつ読み書きする
+inline simd_packed_float4 &Lane4(float *ptr)
+{
+  return *reinterpret_cast<simd_packed_float4 *>(ptr);
+}
+
+} // namespace
+
+//
+// ColorCurve
+//
+ColorCurve::ColorCurve() : ColorCurve(simd_make_float4(1.0f, 1.0f, 1.0f, 1.0f)) {}
+
+ColorCurve::ColorCurve(simd_float4 color)
+{
+  keys_.push_back({0.0f, color});
+  build();
+}
+
+ColorCurve::ColorCurve(simd_float4 start, simd_float4 end)
+{
+  keys_.push_back({0.0f, start});
+  keys_.push_back({1.0f, end});
+  build();
+}
+
+void ColorCurve::addKey(float time, simd_float4 color)
+{
+  Key  key{std::clamp(time, 0.0f, 1.0f), color};
+  auto it = std::upper_bound(
+      keys_.begin(), keys_.end(), key.time, [](float t, const Key &k) { return t < k.time; });
+  keys_.insert(it, key);
+  build();
+}
+
+void ColorCurve::clear()
+{
+  keys_.clear();
+  build();
+}
+
+simd_float4 ColorCurve::evaluate(float time) const
+{
+  if (keys_.empty())
+  {
+    return simd_make_float4(1.0f, 1.0f, 1.0f, 1.0f);
+  }
+  if (time <= keys_.front().time)
+  {
+    return keys_.front().color;
+  }
+  for (size_t i = 1; i < keys_.size(); i++)
+  {
+    const auto &k0 = keys_[i - 1];
+    const auto &k1 = keys_[i];
+    if (time < k1.time)
+    {
+      float rate = (time - k0.time) / std::max(k1.time - k0.time, 1.0e-6f);
+      return simd_mix(k0.color, k1.color, simd_make_float4(rate, rate, rate, rate));
+    }
+  }
+  return keys_.back().color;
+}
+
+// 毎フレームの書き出しで変換しないようにhalfで持っておく
+void ColorCurve::build()
+{
+  for (int i = 0; i <= TableSize; i++)
+  {
+    table_[i] = vcvt_f16_f32(evaluate(float(i) / TableSize));
+  }
+}
+
+//
+// System
+//
+System::System(size_t capacity) : capacity_(capacity)
+{
+  auto size = RoundUp4(capacity);
+  for (auto *array : {&posX_, &posY_, &posZ_, &velX_, &velY_, &velZ_, &age_, &invLife_})
+  {
+    array->resize(size);
+  }
+}
+
+float System::random01()
+{
+  random_ ^= random_ << 13;
+  random_ ^= random_ >> 17;
+  random_ ^= random_ << 5;
+  return (random_ >> 8) * (1.0f / 16777216.0f);
+}
+
+float System::randomSigned() { return random01() * 2.0f - 1.0f; }
+
+//
+void System::emit(size_t count)
+{
+  count = std::min(count, capacity_ - count_);
+  for (size_t n = 0; n < count; n++)
+  {
+    auto i   = count_ + n;
+    posX_[i] = emitter_.position.x + emitter_.positionSpread.x * randomSigned();
+    posY_[i] = emitter_.position.y + emitter_.positionSpread.y * randomSigned();
+    posZ_[i] = emitter_.position.z + emitter_.positionSpread.z * randomSigned();
+    velX_[i] = emitter_.velocity.x + emitter_.velocitySpread.x * randomSigned();
+    velY_[i] = emitter_.velocity.y + emitter_.velocitySpread.y * randomSigned();
+    velZ_[i] = emitter_.velocity.z + emitter_.velocitySpread.z * randomSigned();
+    age_[i]  = 0.0f;
+
+    float life  = emitter_.lifeMin + (emitter_.lifeMax - emitter_.lifeMin) * random01();
+    invLife_[i] = 1.0f / std::max(life, 1.0e-3f);
+  }
+  count_ += count;
+}
+
+//
+void System::update(float dt)
+{
+  // 発生(端数は次のフレームへ持ち越す)
+  emitCarry_ += emitter_.rate * dt;
+  if (emitCarry_ >= 1.0f)
+  {
+    auto n = size_t(emitCarry_);
+    emitCarry_ -= float(n);
+    emit(n);
+  }
+  if (count_ == 0)
+  {
+    return;
+  }
+
+  // v = wind + (v - wind) * damp + gravity * dt
+  float       damp    = std::exp(-forces_.drag * dt);
+  simd_float4 dt4     = dt;
+  simd_float4 damp4   = damp;
+  simd_float4 accel[] = {forces_.gravity.x * dt + forces_.wind.x * (1.0f - damp),
+                         forces_.gravity.y * dt + forces_.wind.y * (1.0f - damp),
+                         forces_.gravity.z * dt + forces_.wind.z * (1.0f - damp)};
+
+  size_t chunks = (count_ + ChunkSize - 1) / ChunkSize;
+  dead_.resize(std::max(dead_.size(), chunks));
+  ParallelFor(chunks,
+              1,
+              [&](size_t cBegin, size_t cEnd)
+              {
+                for (size_t c = cBegin; c < cEnd; c++)
+                {
+                  size_t begin = c * ChunkSize;
+                  size_t end   = std::min(begin + ChunkSize, count_);
+                  auto  &dead  = dead_[c];
+                  dead.clear();
+
+                  // 端数の分も4つ単位で処理する(配列は4の倍数で確保してある)
+                  for (size_t i = begin; i < end; i += 4)
+                  {
+                    simd_packed_float4 *pos[] = {
+                        &Lane4(&posX_[i]), &Lane4(&posY_[i]), &Lane4(&posZ_[i])};
+                    simd_packed_float4 *vel[] = {
+                        &Lane4(&velX_[i]), &Lane4(&velY_[i]), &Lane4(&velZ_[i])};
+                    for (int axis = 0; axis < 3; axis++)
+                    {
+                      *vel[axis] = *vel[axis] * damp4 + accel[axis];
+                      *pos[axis] += *vel[axis] * dt4;
+                    }
+                    auto &age = Lane4(&age_[i]);
+                    age += dt4;
+
+                    auto over = age * Lane4(&invLife_[i]) >= 1.0f;
+                    if (simd_any(over))
+                    {
+                      for (int lane = 0; lane < 4 && i + lane < end; lane++)
+                      {
+                        if (over[lane])
+                        {
+                          dead.push_back(uint32_t(i + lane));
+                        }
+                      }
+                    }
+                  }
+                }
+              });
+
+  // 末尾と入れ替えて詰める
+  // 大きい番号から処理するので、入れ替え元の末尾は常に生きている
+  for (size_t c = chunks; c-- > 0;)
+  {
+    const auto &dead = dead_[c];
+    for (auto it = dead.rbegin(); it != dead.rend(); ++it)
+    {
+      auto index = *it;
+      auto last  = count_ - 1;
+      if (index != last)
+      {
+        posX_[index]    = posX_[last];
+        posY_[index]    = posY_[last];
+        posZ_[index]    = posZ_[last];
+        velX_[index]    = velX_[last];
+        velY_[index]    = velY_[last];
+        velZ_[index]    = velZ_[last];
+        age_[index]     = age_[last];
+        invLife_[index] = invLife_[last];
+      }
+      count_--;
+    }
+  }
+}
+
+//
+void System::clear()
+{
+  count_     = 0;
+  emitCarry_ = 0.0f;
+}
+
+//
+void System::write(Vertex *dst, size_t begin, size_t end, float scale) const
+{
+  float sizeStart = emitter_.sizeStart * scale;
+  float sizeDelta = (emitter_.sizeEnd - emitter_.sizeStart) * scale;
+  for (size_t i = begin; i < end; i++)
+  {
+    float t      = std::min(age_[i] * invLife_[i], 1.0f);
+    auto &vtx    = dst[i - begin];
+    vtx.position = simd_make_float3(posX_[i], posY_[i], posZ_[i]) * scale;
+    vtx.size     = sizeStart + sizeDelta * t;
+    vtx.color    = colorCurve_.lookup(t);
+  }
+}
+
+//
+void System::writeAll(Vertex *dst, float scale) const
+{
+  ParallelFor(count_,
+              ChunkSize,
+              [&](size_t begin, size_t end) { write(dst + begin, begin, end, scale); });
+}
+
+} // namespace Particle
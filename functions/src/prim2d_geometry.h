@@ -0,0 +1,134 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <algorithm>
+#include <arm_neon.h>
+#include <cmath>
+#include <cstddef>
+#include <simd/simd.h>
+
+//
+// 2Dプリミティブの頂点生成(Draw2DとDisplayList2Dで共用)
+// 座標は呼び出し側でスケール済みのものを渡す
+// 頂点はposition(simd_float2)とcolor(float16x4_t)を持つ型(VertexDataPrim2D)
+//
+namespace Prim2D
+{
+constexpr int LineVertices     = 2;
+constexpr int RectLineVertices = 8;
+constexpr int RectFillVertices = 6;
+
+inline int PolygonLineVertices(int sides) { return sides * 2; }
+inline int PolygonFillVertices(int sides) { return sides * 3; }
+
+//
+template <class Vertex>
+inline void WriteLine(Vertex *vtx2d, simd_float2 from, simd_float2 to, float16x4_t color)
+{
+  vtx2d[0].position = from;
+  vtx2d[0].color    = color;
+  vtx2d[1].position = to;
+  vtx2d[1].color    = color;
+}
+
+//
+template <class Vertex>
+inline void WriteRectLines(Vertex *vtx2d, simd_float2 from, simd_float2 to, float16x4_t color)
+{
+  WriteLine(vtx2d + 0, from, simd_make_float2(to.x, from.y), color);
+  WriteLine(vtx2d + 2, from, simd_make_float2(from.x, to.y), color);
+  WriteLine(vtx2d + 4, simd_make_float2(to.x, from.y), to, color);
+  WriteLine(vtx2d + 6, simd_make_float2(from.x, to.y), to, color);
+}
+
+//
+template <class Vertex>
+inline void WriteRectFill(Vertex *vtx2d, simd_float2 from, simd_float2 to, float16x4_t color)
+{
+  vtx2d[0].position = from;
+  vtx2d[1].position = simd_make_float2(to.x, from.y);
+  vtx2d[2].position = simd_make_float2(from.x, to.y);
+  vtx2d[3].position = simd_make_float2(to.x, from.y);
+  vtx2d[4].position = simd_make_float2(from.x, to.y);
+  vtx2d[5].position = to;
+  for (int i = 0; i < RectFillVertices; i++)
+  {
+    vtx2d[i].color = color;
+  }
+}
+
+// 外周の線(sides本)
+template <class Vertex>
+inline void WritePolygonLines(Vertex *vtx2d, simd_float2 pos, float rad, float rot, int sides,
+                              float16x4_t color)
+{
+  float step = (M_PI * 2) / (float)sides;
+  for (int sidx = 0; sidx < sides; sidx++)
+  {
+    auto rot1 = (float)sidx * step + rot;
+    auto rot2 = (float)(sidx + 1) * step + rot;
+    auto pos1 = simd_make_float2(std::sin(rot1), std::cos(rot1));
+    auto pos2 = simd_make_float2(std::sin(rot2), std::cos(rot2));
+    WriteLine(vtx2d, pos1 * rad + pos, pos2 * rad + pos, color);
+    vtx2d += 2;
+  }
+}
+
+// 中心からの扇(sides個の三角形)
+template <class Vertex>
+inline void WritePolygonFill(Vertex *vtx2d, simd_float2 pos, float rad, float rot, int sides,
+                             float16x4_t color)
+{
+  float step = (M_PI * 2) / (float)sides;
+  for (int sidx = 0; sidx < sides; sidx++)
+  {
+    auto rot1 = (float)sidx * step + rot;
+    auto rot2 = (float)(sidx + 1) * step + rot;
+    auto pos1 = simd_make_float2(std::sin(rot1), std::cos(rot1));
+    auto pos2 = simd_make_float2(std::sin(rot2), std::cos(rot2));
+
+    vtx2d[0].position = pos;
+    vtx2d[0].color    = color;
+    vtx2d[1].position = pos1 * rad + pos;
+    vtx2d[1].color    = color;
+    vtx2d[2].position = pos2 * rad + pos;
+    vtx2d[2].color    = color;
+    vtx2d += 3;
+  }
+}
+
+// VisibleChunk個ずつ全部が見える場合の分を確保し、見えるものだけを書き込んで余りを返す
+// (見えるかどうかの判定は1要素につき1回)
+// reserve(頂点数)は頂点領域(足りなければnullptr)を返し、write(頂点, 要素)で1つ分を書き込む
+// release(書き込んだ末尾, 余った頂点数)で使わなかった分を返す
+constexpr size_t VisibleChunk = 1024;
+
+template <class Item, class Visible, class Reserve, class Write, class Release>
+inline void WriteVisible(const Item *items, size_t count, int vertices, Visible &&visible,
+                         Reserve &&reserve, Write &&write, Release &&release)
+{
+  for (size_t begin = 0; begin < count; begin += VisibleChunk)
+  {
+    auto  end   = std::min(begin + VisibleChunk, count);
+    auto  nbMax = (end - begin) * vertices;
+    auto *vtx2d = reserve(nbMax);
+    if (vtx2d == nullptr)
+    {
+      return;
+    }
+    auto *top = vtx2d;
+    for (size_t i = begin; i < end; i++)
+    {
+      if (visible(items[i]))
+      {
+        write(vtx2d, items[i]);
+        vtx2d += vertices;
+      }
+    }
+    release(vtx2d, nbMax - (size_t)(vtx2d - top));
+  }
+}
+
+} // namespace Prim2D
@@ -0,0 +1,108 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "prim_batch.h"
+#include <arm_neon.h>
+#include <cstddef>
+#include <simd/simd.h>
+
+//
+// 3Dプリミティブの頂点生成(Draw3Dの1つずつの描画とまとめた描画で共用)
+// 頂点はposition(simd_float3)とcolor(float16x4_t)を持つ型(VertexDataPrim3D)
+// 頂点領域はreserveで受け取る(足りなければnullptrを返す)
+//
+namespace Prim3D
+{
+
+//
+template <class Vertex>
+inline void WriteLine(Vertex *vtx3d, simd_float3 from, simd_float3 to, float16x4_t color)
+{
+  vtx3d[0].position = from;
+  vtx3d[0].color    = color;
+  vtx3d[1].position = to;
+  vtx3d[1].color    = color;
+}
+
+//
+template <class Vertex>
+inline void WriteTriangle(Vertex *vtx3d, simd_float3 p0, simd_float3 p1, simd_float3 p2,
+                          float16x4_t color)
+{
+  vtx3d[0].position = p0;
+  vtx3d[0].color    = color;
+  vtx3d[1].position = p1;
+  vtx3d[1].color    = color;
+  vtx3d[2].position = p2;
+  vtx3d[2].color    = color;
+}
+
+// reserve(頂点数)で1回だけ確保する
+template <class Reserve>
+inline void WriteLines(const Line3D *lines, size_t count, Reserve &&reserve)
+{
+  auto *vtx3d = count > 0 ? reserve(count * 2) : nullptr;
+  if (vtx3d == nullptr)
+  {
+    return;
+  }
+  for (size_t i = 0; i < count; i++, vtx3d += 2)
+  {
+    const auto &line = lines[i];
+    WriteLine(vtx3d, line.from, line.to, vcvt_f16_f32(line.color));
+  }
+}
+
+// colorsは1色か三角形毎(colorCount == count)
+// reserve(頂点数, 半透明か)で不透明と半透明をそれぞれ1回だけ確保する
+template <class Reserve>
+inline void WriteTriangles(const Triangle3D *triangles, size_t count, const simd_float4 *colors,
+                           size_t colorCount, Reserve &&reserve)
+{
+  if (count == 0 || (colorCount != 1 && colorCount != count))
+  {
+    return;
+  }
+
+  if (colorCount == 1)
+  {
+    auto *vtx3d = reserve(count * 3, colors[0].w < 1.0f);
+    if (vtx3d == nullptr)
+    {
+      return;
+    }
+    auto col16 = vcvt_f16_f32(colors[0]);
+    for (size_t i = 0; i < count; i++, vtx3d += 3)
+    {
+      const auto &tri = triangles[i];
+      WriteTriangle(vtx3d, tri.p0, tri.p1, tri.p2, col16);
+    }
+    return;
+  }
+
+  // 不透明と半透明に振り分ける(足りない時はそれぞれ全て捨てる)
+  size_t nbTranslucent = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    nbTranslucent += colors[i].w < 1.0f ? 1 : 0;
+  }
+  size_t nbOpaque = count - nbTranslucent;
+
+  decltype(reserve(size_t{}, false)) dst[2] = {
+      nbOpaque > 0 ? reserve(nbOpaque * 3, false) : nullptr,
+      nbTranslucent > 0 ? reserve(nbTranslucent * 3, true) : nullptr};
+  for (size_t i = 0; i < count; i++)
+  {
+    auto *&vtx3d = dst[colors[i].w < 1.0f ? 1 : 0];
+    if (vtx3d != nullptr)
+    {
+      const auto &tri = triangles[i];
+      WriteTriangle(vtx3d, tri.p0, tri.p1, tri.p2, vcvt_f16_f32(colors[i]));
+      vtx3d += 3;
+    }
+  }
+}
+
+} // namespace Prim3D
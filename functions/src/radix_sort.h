@@ -0,0 +1,178 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "parallel_for.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//
+// 64bitキーの安定LSD基数ソート(8bit x 8パス)
+// 全要素で同じ値になる桁はパスごと省略する
+// key(item) -> uint64_t, tempは作業領域(再利用してよい)
+//
+template <class T, class KeyFunc>
+void RadixSort(std::vector<T> &items, std::vector<T> &temp, KeyFunc &&key)
+{
+  const size_t count = items.size();
+  if (count < 2)
+  {
+    return;
+  }
+
+  std::array<std::array<uint32_t, 256>, 8> histogram{};
+  for (const auto &item : items)
+  {
+    auto k = key(item);
+    for (int pass = 0; pass < 8; pass++)
+    {
+      histogram[pass][(k >> (pass * 8)) & 0xff]++;
+    }
+  }
+
+  temp.resize(count);
+  auto *src = &items;
+  auto *dst = &temp;
+  for (int pass = 0; pass < 8; pass++)
+  {
+    auto &hist = histogram[pass];
+    auto  k0   = (key((*src)[0]) >> (pass * 8)) & 0xff;
+    if (hist[k0] == count)
+    {
+      continue;
+    }
+
+    uint32_t offset = 0;
+    for (auto &h : hist)
+    {
+      auto n = h;
+      h      = offset;
+      offset += n;
+    }
+    for (auto &item : *src)
+    {
+      auto digit            = (key(item) >> (pass * 8)) & 0xff;
+      (*dst)[hist[digit]++] = std::move(item);
+    }
+    std::swap(src, dst);
+  }
+
+  if (src != &items)
+  {
+    items.swap(temp);
+  }
+}
+
+//
+// RadixSortの並列版(結果は同じ)
+// blockSize単位で桁の数を数え、ブロック順に書き込み位置を割り当てるので安定
+//
+template <class T, class KeyFunc>
+void ParallelRadixSort(std::vector<T> &items, std::vector<T> &temp, KeyFunc &&key,
+                       size_t blockSize = 16384)
+{
+  const size_t count  = items.size();
+  const size_t blocks = (count + blockSize - 1) / blockSize;
+  if (blocks < 2)
+  {
+    RadixSort(items, temp, key);
+    return;
+  }
+
+  // 省略できる桁を調べる(全体の分布は並び順に依らない)
+  using Histogram = std::array<uint32_t, 256>;
+  std::vector<std::array<Histogram, 8>> totals(blocks);
+  ParallelFor(blocks,
+              1,
+              [&](size_t bBegin, size_t bEnd)
+              {
+                for (size_t b = bBegin; b < bEnd; b++)
+                {
+                  auto &hist = totals[b];
+                  hist       = {};
+                  size_t end = std::min((b + 1) * blockSize, count);
+                  for (size_t i = b * blockSize; i < end; i++)
+                  {
+                    auto k = key(items[i]);
+                    for (int pass = 0; pass < 8; pass++)
+                    {
+                      hist[pass][(k >> (pass * 8)) & 0xff]++;
+                    }
+                  }
+                }
+              });
+
+  temp.resize(count);
+  auto                  *src = &items;
+  auto                  *dst = &temp;
+  std::vector<Histogram> offsets(blocks);
+  for (int pass = 0; pass < 8; pass++)
+  {
+    auto     k0   = (key((*src)[0]) >> (pass * 8)) & 0xff;
+    uint32_t same = 0;
+    for (const auto &hist : totals)
+    {
+      same += hist[pass][k0];
+    }
+    if (same == count)
+    {
+      continue;
+    }
+
+    // ブロック毎の分布は現在の並び順で数え直す
+    ParallelFor(blocks,
+                1,
+                [&](size_t bBegin, size_t bEnd)
+                {
+                  for (size_t b = bBegin; b < bEnd; b++)
+                  {
+                    auto &hist = offsets[b];
+                    hist       = {};
+                    size_t end = std::min((b + 1) * blockSize, count);
+                    for (size_t i = b * blockSize; i < end; i++)
+                    {
+                      hist[(key((*src)[i]) >> (pass * 8)) & 0xff]++;
+                    }
+                  }
+                });
+
+    uint32_t offset = 0;
+    for (size_t digit = 0; digit < 256; digit++)
+    {
+      for (auto &hist : offsets)
+      {
+        auto n      = hist[digit];
+        hist[digit] = offset;
+        offset += n;
+      }
+    }
+
+    ParallelFor(blocks,
+                1,
+                [&](size_t bBegin, size_t bEnd)
+                {
+                  for (size_t b = bBegin; b < bEnd; b++)
+                  {
+                    auto  &hist = offsets[b];
+                    size_t end  = std::min((b + 1) * blockSize, count);
+                    for (size_t i = b * blockSize; i < end; i++)
+                    {
+                      auto &item            = (*src)[i];
+                      auto  digit           = (key(item) >> (pass * 8)) & 0xff;
+                      (*dst)[hist[digit]++] = std::move(item);
+                    }
+                  }
+                });
+    std::swap(src, dst);
+  }
+
+  if (src != &items)
+  {
+    items.swap(temp);
+  }
+}
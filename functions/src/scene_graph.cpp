@@ -0,0 +1,402 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "scene_graph.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <atomic>
+
+namespace Scene
+{
+
+namespace
+{
+constexpr uint32_t InvalidIndex = 0xffffffff;
+
+// 1つの深さにこれ以上あれば並列に計算する
+constexpr size_t ParallelThreshold = 4096;
+constexpr size_t ParallelGrain     = 1024;
+
+//
+inline simd_float4x4 LocalMatrix(const Transform &t)
+{
+  auto rot = simd_matrix3x3(t.rotation);
+  return simd_matrix(simd_make_float4(rot.columns[0] * t.scale.x, 0.0f),
+                     simd_make_float4(rot.columns[1] * t.scale.y, 0.0f),
+                     simd_make_float4(rot.columns[2] * t.scale.z, 0.0f),
+                     simd_make_float4(t.position, 1.0f));
+}
+
+// new位置 -> old位置 の並びに入れ替える
+template <class T>
+void Permute(std::vector<T> &items, const std::vector<uint32_t> &order)
+{
+  std::vector<T> sorted(order.size());
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    sorted[i] = items[order[i]];
+  }
+  items.swap(sorted);
+}
+
+} // namespace
+
+//
+NodeId Graph::create(NodeId parent, const Transform &local)
+{
+  uint32_t parentIndex = contains(parent) ? indexOf_[parent] : InvalidIndex;
+  uint32_t depth       = parentIndex == InvalidIndex ? 0 : depth_[parentIndex] + 1;
+
+  NodeId id;
+  if (!freeIds_.empty())
+  {
+    id = freeIds_.back();
+    freeIds_.pop_back();
+  }
+  else
+  {
+    id = NodeId(indexOf_.size());
+    indexOf_.push_back(InvalidIndex);
+  }
+
+  // 末尾に追加して深さ順が崩れる時だけ並べ直す
+  auto index = uint32_t(ids_.size());
+  if (!depth_.empty() && depth < depth_.back())
+  {
+    orderDirty_ = true;
+  }
+  ids_.push_back(id);
+  parent_.push_back(parentIndex);
+  depth_.push_back(depth);
+  local_.push_back(local);
+  world_.push_back(matrix_identity_float4x4);
+  dirty_.push_back(0);
+  changed_.push_back(0);
+  indexOf_[id] = index;
+
+  if (!orderDirty_)
+  {
+    if (levelStart_.empty())
+    {
+      levelStart_.push_back(0);
+    }
+    while (levelStart_.size() < depth + 2)
+    {
+      levelStart_.push_back(index);
+    }
+    levelStart_.back() = index + 1;
+  }
+  markDirty(index);
+  return id;
+}
+
+//
+void Graph::destroy(NodeId id)
+{
+  if (!contains(id))
+  {
+    return;
+  }
+  if (orderDirty_)
+  {
+    rebuildOrder();
+  }
+
+  // 親は子より前にあるので1回で子孫まで印が付く
+  size_t               count = ids_.size();
+  std::vector<uint8_t> removed(count, 0);
+  removed[indexOf_[id]] = 1;
+  for (size_t i = indexOf_[id] + 1; i < count; i++)
+  {
+    auto p     = parent_[i];
+    removed[i] = p != InvalidIndex && removed[p];
+  }
+
+  // 順序を保ったまま詰める
+  std::vector<uint32_t> newIndex(count, InvalidIndex);
+  uint32_t              write = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    if (removed[i])
+    {
+      indexOf_[ids_[i]] = InvalidIndex;
+      freeIds_.push_back(ids_[i]);
+      continue;
+    }
+    auto p                = parent_[i];
+    newIndex[i]           = write;
+    ids_[write]           = ids_[i];
+    parent_[write]        = p == InvalidIndex ? InvalidIndex : newIndex[p];
+    depth_[write]         = depth_[i];
+    local_[write]         = local_[i];
+    world_[write]         = world_[i];
+    dirty_[write]         = dirty_[i];
+    changed_[write]       = changed_[i];
+    indexOf_[ids_[write]] = write;
+    write++;
+  }
+  ids_.resize(write);
+  parent_.resize(write);
+  depth_.resize(write);
+  local_.resize(write);
+  world_.resize(write);
+  dirty_.resize(write);
+  changed_.resize(write);
+  rebuildLevels();
+}
+
+//
+bool Graph::setParent(NodeId id, NodeId parent)
+{
+  if (!contains(id))
+  {
+    return false;
+  }
+  uint32_t index       = indexOf_[id];
+  uint32_t parentIndex = contains(parent) ? indexOf_[parent] : InvalidIndex;
+  for (auto p = parentIndex; p != InvalidIndex; p = parent_[p])
+  {
+    if (p == index)
+    {
+      return false;
+    }
+  }
+
+  // 子孫の深さも変わるので次のupdate()でまとめて並べ直す
+  parent_[index] = parentIndex;
+  orderDirty_    = true;
+  dirty_[index]  = 1;
+  return true;
+}
+
+//
+void Graph::clear()
+{
+  ids_.clear();
+  parent_.clear();
+  depth_.clear();
+  local_.clear();
+  world_.clear();
+  dirty_.clear();
+  changed_.clear();
+  levelStart_.clear();
+  indexOf_.clear();
+  freeIds_.clear();
+  minDirtyDepth_ = UINT32_MAX;
+  maxDirtyDepth_ = 0;
+  orderDirty_    = false;
+}
+
+//
+bool Graph::contains(NodeId id) const
+{
+  return id < indexOf_.size() && indexOf_[id] != InvalidIndex;
+}
+
+//
+NodeId Graph::parent(NodeId id) const
+{
+  auto p = parent_[indexOf_[id]];
+  return p == InvalidIndex ? InvalidNode : ids_[p];
+}
+
+//
+void Graph::markDirty(uint32_t index)
+{
+  dirty_[index]  = 1;
+  minDirtyDepth_ = std::min(minDirtyDepth_, depth_[index]);
+  maxDirtyDepth_ = std::max(maxDirtyDepth_, depth_[index]);
+}
+
+//
+void Graph::setLocal(NodeId id, const Transform &local)
+{
+  auto index    = indexOf_[id];
+  local_[index] = local;
+  markDirty(index);
+}
+
+//
+void Graph::setPosition(NodeId id, simd_float3 position)
+{
+  auto index             = indexOf_[id];
+  local_[index].position = position;
+  markDirty(index);
+}
+
+//
+void Graph::setRotation(NodeId id, simd_quatf rotation)
+{
+  auto index             = indexOf_[id];
+  local_[index].rotation = rotation;
+  markDirty(index);
+}
+
+//
+void Graph::setScale(NodeId id, simd_float3 scale)
+{
+  auto index          = indexOf_[id];
+  local_[index].scale = scale;
+  markDirty(index);
+}
+
+//
+uint32_t Graph::depthOf(uint32_t index) const
+{
+  uint32_t depth = 0;
+  for (auto p = parent_[index]; p != InvalidIndex; p = parent_[p])
+  {
+    depth++;
+  }
+  return depth;
+}
+
+//
+void Graph::rebuildLevels()
+{
+  levelStart_.clear();
+  if (ids_.empty())
+  {
+    return;
+  }
+  levelStart_.resize(depth_.back() + 2, 0);
+  for (auto depth : depth_)
+  {
+    levelStart_[depth + 1]++;
+  }
+  for (size_t d = 1; d < levelStart_.size(); d++)
+  {
+    levelStart_[d] += levelStart_[d - 1];
+  }
+}
+
+//
+void Graph::rebuildOrder()
+{
+  size_t count = ids_.size();
+  for (size_t i = 0; i < count; i++)
+  {
+    depth_[i] = depthOf(uint32_t(i));
+  }
+
+  // 深さで安定に並べる(計数ソート)
+  uint32_t              maxDepth = count > 0 ? *std::max_element(depth_.begin(), depth_.end()) : 0;
+  std::vector<uint32_t> cursor(maxDepth + 1, 0);
+  for (auto depth : depth_)
+  {
+    cursor[depth]++;
+  }
+  uint32_t offset = 0;
+  for (auto &c : cursor)
+  {
+    auto n = c;
+    c      = offset;
+    offset += n;
+  }
+  std::vector<uint32_t> order(count);
+  std::vector<uint32_t> newIndex(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    auto pos    = cursor[depth_[i]]++;
+    order[pos]  = uint32_t(i);
+    newIndex[i] = pos;
+  }
+
+  Permute(ids_, order);
+  Permute(parent_, order);
+  Permute(depth_, order);
+  Permute(local_, order);
+  Permute(world_, order);
+  Permute(dirty_, order);
+  Permute(changed_, order);
+  minDirtyDepth_ = UINT32_MAX;
+  maxDirtyDepth_ = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    auto &p           = parent_[i];
+    p                 = p == InvalidIndex ? InvalidIndex : newIndex[p];
+    indexOf_[ids_[i]] = uint32_t(i);
+    if (dirty_[i])
+    {
+      markDirty(uint32_t(i));
+    }
+  }
+  rebuildLevels();
+  orderDirty_ = false;
+}
+
+//
+bool Graph::updateRange(size_t begin, size_t end)
+{
+  bool any = false;
+  for (size_t i = begin; i < end; i++)
+  {
+    auto p             = parent_[i];
+    bool parentChanged = p != InvalidIndex && changed_[p] == serial_;
+    if (!dirty_[i] && !parentChanged)
+    {
+      continue;
+    }
+    auto localMtx = LocalMatrix(local_[i]);
+    world_[i]     = p == InvalidIndex ? localMtx : simd_mul(world_[p], localMtx);
+    dirty_[i]     = 0;
+    changed_[i]   = serial_;
+    any           = true;
+  }
+  return any;
+}
+
+//
+void Graph::update()
+{
+  if (orderDirty_)
+  {
+    rebuildOrder();
+  }
+  if (minDirtyDepth_ == UINT32_MAX)
+  {
+    return;
+  }
+  if (++serial_ == 0)
+  {
+    std::fill(changed_.begin(), changed_.end(), 0);
+    serial_ = 1;
+  }
+
+  // 浅い方から1段ずつ(同じ深さのノードは互いに依存しない)
+  size_t levels = levelStart_.size() - 1;
+  for (size_t d = minDirtyDepth_; d < levels; d++)
+  {
+    size_t begin = levelStart_[d];
+    size_t end   = levelStart_[d + 1];
+    bool   any   = false;
+    if (end - begin >= ParallelThreshold)
+    {
+      std::atomic<bool> anyAtomic{false};
+      ParallelFor(end - begin,
+                  ParallelGrain,
+                  [&](size_t b, size_t e)
+                  {
+                    if (updateRange(begin + b, begin + e))
+                    {
+                      anyAtomic.store(true, std::memory_order_relaxed);
+                    }
+                  });
+      any = anyAtomic.load();
+    }
+    else
+    {
+      any = updateRange(begin, end);
+    }
+
+    // これより深いところに変更がなければ終わり
+    if (!any && d >= maxDirtyDepth_)
+    {
+      break;
+    }
+  }
+  minDirtyDepth_ = UINT32_MAX;
+  maxDirtyDepth_ = 0;
+}
+
+} // namespace Scene
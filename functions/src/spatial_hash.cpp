@@ -0,0 +1,399 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "spatial_hash.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr uint32_t InvalidSlot = 0xffffffff;
+
+// これより多くのセルを覆うものはグリッドに入れずに毎回調べる
+constexpr int64_t MaxCellsPerItem = 64;
+
+//
+inline float Cross(simd_float2 a, simd_float2 b) { return a.x * b.y - a.y * b.x; }
+
+// 凸多角形(どちら回りでもよい)の内側か
+inline bool Contains(const simd_float2 *quad, simd_float2 point)
+{
+  bool negative = false;
+  bool positive = false;
+  for (int i = 0; i < 4; i++)
+  {
+    auto c = Cross(quad[(i + 1) & 3] - quad[i], point - quad[i]);
+    negative |= c < 0.0f;
+    positive |= c > 0.0f;
+  }
+  return !(negative && positive);
+}
+
+// axisに投影した範囲
+inline simd_float2 Project(const simd_float2 *points, int count, simd_float2 axis)
+{
+  float lo = simd_dot(points[0], axis);
+  float hi = lo;
+  for (int i = 1; i < count; i++)
+  {
+    float d = simd_dot(points[i], axis);
+    lo      = std::min(lo, d);
+    hi      = std::max(hi, d);
+  }
+  return simd_make_float2(lo, hi);
+}
+
+// aの辺の法線で分離できるか
+inline bool Separated(const simd_float2 *a, const simd_float2 *b, int countB)
+{
+  for (int i = 0; i < 4; i++)
+  {
+    auto edge = a[(i + 1) & 3] - a[i];
+    auto axis = simd_make_float2(-edge.y, edge.x);
+    auto pa   = Project(a, 4, axis);
+    auto pb   = Project(b, countB, axis);
+    if (pa.y < pb.x || pb.y < pa.x)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// 外接矩形は重なっている前提で、凸多角形同士の分離軸判定
+inline bool Intersects(const simd_float2 *a, const simd_float2 *b)
+{
+  return !Separated(a, b, 4) && !Separated(b, a, 4);
+}
+
+inline bool Overlaps(simd_float2 alo, simd_float2 ahi, simd_float2 blo, simd_float2 bhi)
+{
+  return alo.x <= bhi.x && blo.x <= ahi.x && alo.y <= bhi.y && blo.y <= ahi.y;
+}
+
+// セルの範囲(x0, y0, x1, y1)に含まれるセルの数
+inline int64_t CellCount(const int32_t *cell)
+{
+  return (int64_t(cell[2]) - cell[0] + 1) * (int64_t(cell[3]) - cell[1] + 1);
+}
+
+} // namespace
+
+//
+SpatialHash2D::SpatialHash2D(float cellSize, size_t bucketCount)
+    : invCellSize_(1.0f / cellSize)
+{
+  // 2のべき乗に切り上げる
+  size_t count = 1;
+  while (count < bucketCount)
+  {
+    count <<= 1;
+  }
+  buckets_.resize(count);
+}
+
+//
+size_t SpatialHash2D::bucketOf(int32_t x, int32_t y) const
+{
+  auto h = uint32_t(x) * 0x9E3779B1u ^ uint32_t(y) * 0x85EBCA77u;
+  return (h ^ (h >> 15)) & (buckets_.size() - 1);
+}
+
+//
+void SpatialHash2D::cellRange(const Item &item, int32_t *cell) const
+{
+  auto lo = simd_floor(item.lo * invCellSize_);
+  auto hi = simd_floor(item.hi * invCellSize_);
+  cell[0] = int32_t(std::clamp(lo.x, -1.0e9f, 1.0e9f));
+  cell[1] = int32_t(std::clamp(lo.y, -1.0e9f, 1.0e9f));
+  cell[2] = int32_t(std::clamp(hi.x, -1.0e9f, 1.0e9f));
+  cell[3] = int32_t(std::clamp(hi.y, -1.0e9f, 1.0e9f));
+}
+
+//
+void SpatialHash2D::link(const Item &item)
+{
+  if (item.large)
+  {
+    large_.push_back(item.handle);
+    return;
+  }
+  for (int32_t y = item.cell[1]; y <= item.cell[3]; y++)
+  {
+    for (int32_t x = item.cell[0]; x <= item.cell[2]; x++)
+    {
+      buckets_[bucketOf(x, y)].push_back(item.handle);
+    }
+  }
+}
+
+//
+void SpatialHash2D::unlink(const Item &item)
+{
+  auto erase = [&](std::vector<Handle> &list)
+  {
+    auto it = std::find(list.begin(), list.end(), item.handle);
+    if (it != list.end())
+    {
+      *it = list.back();
+      list.pop_back();
+    }
+  };
+  if (item.large)
+  {
+    erase(large_);
+    return;
+  }
+  for (int32_t y = item.cell[1]; y <= item.cell[3]; y++)
+  {
+    for (int32_t x = item.cell[0]; x <= item.cell[2]; x++)
+    {
+      erase(buckets_[bucketOf(x, y)]);
+    }
+  }
+}
+
+//
+uint32_t SpatialHash2D::nextMark()
+{
+  if (++markStamp_ == 0)
+  {
+    std::fill(mark_.begin(), mark_.end(), 0);
+    markStamp_ = 1;
+  }
+  return markStamp_;
+}
+
+// 外接矩形(lo-hi)と重なるセルの要素を1回ずつ渡す(外接矩形同士の判定まで)
+template <class Func>
+void SpatialHash2D::forEachNear(simd_float2 lo, simd_float2 hi, Func &&func)
+{
+  auto stamp = nextMark();
+  auto visit = [&](Handle handle)
+  {
+    auto slot = slotOf_[handle];
+    if (mark_[slot] == stamp)
+    {
+      return;
+    }
+    mark_[slot]      = stamp;
+    const auto &item = items_[slot];
+    if (Overlaps(lo, hi, item.lo, item.hi))
+    {
+      func(item);
+    }
+  };
+
+  Item range;
+  range.lo = lo;
+  range.hi = hi;
+  cellRange(range, range.cell);
+  if (CellCount(range.cell) > int64_t(items_.size()))
+  {
+    // セルを回るより全部見た方が速い
+    for (const auto &item : items_)
+    {
+      visit(item.handle);
+    }
+    return;
+  }
+  for (int32_t y = range.cell[1]; y <= range.cell[3]; y++)
+  {
+    for (int32_t x = range.cell[0]; x <= range.cell[2]; x++)
+    {
+      for (auto handle : buckets_[bucketOf(x, y)])
+      {
+        visit(handle);
+      }
+    }
+  }
+  for (auto handle : large_)
+  {
+    visit(handle);
+  }
+}
+
+//
+void SpatialHash2D::update(Handle handle, const simd_float2 *corners, uint64_t order)
+{
+  if (handle == NoHandle)
+  {
+    return;
+  }
+  if (handle >= slotOf_.size())
+  {
+    slotOf_.resize(handle + 1, InvalidSlot);
+  }
+
+  Item next;
+  // ストリップ順(0,1,2,3) -> 外周順(0,1,3,2)
+  next.quad[0] = corners[0];
+  next.quad[1] = corners[1];
+  next.quad[2] = corners[3];
+  next.quad[3] = corners[2];
+  next.lo      = simd_min(simd_min(corners[0], corners[1]), simd_min(corners[2], corners[3]));
+  next.hi      = simd_max(simd_max(corners[0], corners[1]), simd_max(corners[2], corners[3]));
+  next.order   = order;
+  next.frame   = frame_;
+  next.handle  = handle;
+  cellRange(next, next.cell);
+  next.large = CellCount(next.cell) > MaxCellsPerItem;
+
+  auto slot = slotOf_[handle];
+  if (slot == InvalidSlot)
+  {
+    slotOf_[handle] = uint32_t(items_.size());
+    items_.push_back(next);
+    mark_.push_back(0);
+    link(next);
+    return;
+  }
+
+  // 覆うセルが変わった時だけ付け替える
+  auto &item = items_[slot];
+  bool  same = item.large == next.large && std::equal(item.cell, item.cell + 4, next.cell);
+  if (!same)
+  {
+    unlink(item);
+    link(next);
+  }
+  item = next;
+}
+
+//
+void SpatialHash2D::remove(Handle handle)
+{
+  if (!contains(handle))
+  {
+    return;
+  }
+  auto slot = slotOf_[handle];
+  unlink(items_[slot]);
+
+  // 末尾と入れ替えて詰める
+  auto last = uint32_t(items_.size() - 1);
+  if (slot != last)
+  {
+    items_[slot]                 = items_[last];
+    mark_[slot]                  = mark_[last];
+    slotOf_[items_[slot].handle] = slot;
+  }
+  items_.pop_back();
+  mark_.pop_back();
+  slotOf_[handle] = InvalidSlot;
+}
+
+//
+void SpatialHash2D::clear()
+{
+  for (auto &bucket : buckets_)
+  {
+    bucket.clear();
+  }
+  items_.clear();
+  slotOf_.clear();
+  large_.clear();
+  mark_.clear();
+}
+
+//
+void SpatialHash2D::sweep()
+{
+  for (size_t i = items_.size(); i-- > 0;)
+  {
+    if (items_[i].frame != frame_)
+    {
+      remove(items_[i].handle);
+    }
+  }
+}
+
+//
+bool SpatialHash2D::contains(Handle handle) const
+{
+  return handle < slotOf_.size() && slotOf_[handle] != InvalidSlot;
+}
+
+// 手前のものから並べる
+void SpatialHash2D::sortByOrder(std::vector<Handle> &out, size_t start) const
+{
+  auto order = [&](Handle handle) { return items_[slotOf_[handle]].order; };
+  std::sort(
+      out.begin() + start, out.end(), [&](Handle a, Handle b) { return order(a) > order(b); });
+}
+
+//
+void SpatialHash2D::queryPoint(simd_float2 point, std::vector<Handle> &out)
+{
+  auto start = out.size();
+  forEachNear(point,
+              point,
+              [&](const Item &item)
+              {
+                if (Contains(item.quad, point))
+                {
+                  out.push_back(item.handle);
+                }
+              });
+  sortByOrder(out, start);
+}
+
+//
+void SpatialHash2D::queryRect(simd_float2 from, simd_float2 to, std::vector<Handle> &out)
+{
+  auto        lo      = simd_min(from, to);
+  auto        hi      = simd_max(from, to);
+  simd_float2 rect[4] = {lo, simd_make_float2(hi.x, lo.y), hi, simd_make_float2(lo.x, hi.y)};
+  auto        start   = out.size();
+  forEachNear(lo,
+              hi,
+              [&](const Item &item)
+              {
+                // 矩形の軸は外接矩形で判定済み
+                if (!Separated(item.quad, rect, 4))
+                {
+                  out.push_back(item.handle);
+                }
+              });
+  sortByOrder(out, start);
+}
+
+//
+void SpatialHash2D::queryOverlaps(Handle handle, std::vector<Handle> &out)
+{
+  if (!contains(handle))
+  {
+    return;
+  }
+  auto        start  = out.size();
+  const auto &target = items_[slotOf_[handle]];
+  forEachNear(target.lo,
+              target.hi,
+              [&](const Item &item)
+              {
+                if (item.handle != handle && Intersects(target.quad, item.quad))
+                {
+                  out.push_back(item.handle);
+                }
+              });
+  sortByOrder(out, start);
+}
+
+//
+void SpatialHash2D::queryPairs(std::vector<std::pair<Handle, Handle>> &out)
+{
+  // 自分より後ろにあるものとだけ組にする
+  for (uint32_t slot = 0; slot < items_.size(); slot++)
+  {
+    const auto &target = items_[slot];
+    forEachNear(target.lo,
+                target.hi,
+                [&](const Item &item)
+                {
+                  if (slotOf_[item.handle] > slot && Intersects(target.quad, item.quad))
+                  {
+                    out.emplace_back(target.handle, item.handle);
+                  }
+                });
+  }
+}
@@ -2,11 +2,57 @@
 // Copyright 2024 Y.Suzuki(wave.suzuki.z@gmail.com)
 //
 #import "sprite.h"
+#include "image_downsample.h"
+#include "image_filter.h"
+#import "texture_cache.h"
 #include <CoreGraphics/CoreGraphics.h>
 #import <CoreImage/CoreImage.h>
 #import <MetalKit/MetalKit.h>
 #include <cmath>
+#include <mutex>
 #include <simd/simd.h>
+#include <vector>
+
+namespace
+{
+// フィルタの出力先(GPUが読んでいる間に書き換えないように、描画中のフレーム数だけ用意して回す)
+constexpr int FilterTextureCount = 3;
+
+// スプライトの番号(破棄したものから再利用して小さく保つ)
+struct HandlePool
+{
+  std::mutex            mutex;
+  std::vector<uint32_t> freeHandles;
+  uint32_t              next = 1;
+};
+
+// 終了時に破棄されるスプライトがあっても使えるように解放しない
+HandlePool &GetHandlePool()
+{
+  static auto *pool = new HandlePool;
+  return *pool;
+}
+
+uint32_t AllocHandle()
+{
+  auto                       &pool = GetHandlePool();
+  std::lock_guard<std::mutex> lock{pool.mutex};
+  if (pool.freeHandles.empty())
+  {
+    return pool.next++;
+  }
+  auto handle = pool.freeHandles.back();
+  pool.freeHandles.pop_back();
+  return handle;
+}
+
+void ReleaseHandle(uint32_t handle)
+{
+  auto                       &pool = GetHandlePool();
+  std::lock_guard<std::mutex> lock{pool.mutex};
+  pool.freeHandles.push_back(handle);
+}
+} // namespace
 
 @implementation Sprite
 {
@@ -14,16 +60,30 @@
   CIContext      *context_;
   CGColorSpaceRef colorSpace_;
   CIFilter       *filter_;
+  TextureCache   *cache_;
   SprPosList      posList;
+
+  std::shared_ptr<ImageFilter::Graph> imageFilter_;
+  id<MTLTexture>                      filterTex_[FilterTextureCount];
+  int                                 filterIndex_;
 }
 
-@synthesize texObj, color, rotate, align, position, scale;
+@synthesize texObj, color, rotate, align, position, scale, handle;
 
 //
 - (nonnull instancetype)initWithTexture:(nullable id<MTLTexture>)texture
+{
+  return [self initWithTexture:texture cache:nil];
+}
+
+// cacheから取得したテクスチャは破棄時にcacheへ返す
+- (nonnull instancetype)initWithTexture:(nullable id<MTLTexture>)texture
+                                  cache:(nullable TextureCache *)cache
 {
   self   = [super init];
   texObj = [texture retain];
+  cache_ = [cache retain];
+  handle = AllocHandle();
   posList.resize(4);
   align       = SpriteAlignLeftTop;
   rotate      = 0.0f;
@@ -39,10 +99,19 @@
 //
 - (nonnull instancetype)initWithImage:(nonnull CIImage *)image
                               texture:(nullable id<MTLTexture>)texture
+{
+  return [self initWithImage:image texture:texture cache:nil];
+}
+
+- (nonnull instancetype)initWithImage:(nonnull CIImage *)image
+                              texture:(nullable id<MTLTexture>)texture
+                                cache:(nullable TextureCache *)cache
 {
   self   = [super init];
   texObj = [texture retain];
+  cache_ = [cache retain];
   image_ = [image retain];
+  handle = AllocHandle();
   posList.resize(4);
   align       = SpriteAlignLeftTop;
   rotate      = 0.0f;
@@ -69,6 +138,12 @@
   {
     [context_ release];
   }
+  [self releaseFilterTexture];
+  if (cache_ != nil)
+  {
+    [cache_ releaseTexture:texObj];
+    [cache_ release];
+  }
   if (texObj != nil)
   {
     [texObj release];
@@ -77,6 +152,7 @@
   {
     [image_ release];
   }
+  ReleaseHandle(handle);
   [super dealloc];
 }
 
@@ -113,6 +189,113 @@
          colorSpace:colorSpace_];
 }
 
+// フィルタ適用中は最後に書き込んだ出力先を返す
+- (nullable id<MTLTexture>)texObj
+{
+  auto filterTex = filterTex_[filterIndex_];
+  return filterTex != nil ? filterTex : texObj;
+}
+
+- (void)releaseFilterTexture
+{
+  for (auto &filterTex : filterTex_)
+  {
+    if (filterTex != nil)
+    {
+      [cache_ releaseTexture:filterTex];
+      [filterTex release];
+      filterTex = nil;
+    }
+  }
+  filterIndex_ = 0;
+}
+
+// 書き込み先のテクスチャ(初めて使う時に作る)
+- (nonnull id<MTLTexture>)filterTextureAt:(int)index
+{
+  if (filterTex_[index] == nil)
+  {
+    auto width               = texObj.width;
+    auto height              = texObj.height;
+    auto texdesc             = [[MTLTextureDescriptor alloc] init];
+    texdesc.width            = width;
+    texdesc.height           = height;
+    texdesc.pixelFormat      = texObj.pixelFormat;
+    texdesc.textureType      = MTLTextureType2D;
+    texdesc.mipmapLevelCount = ImageDownsample::MipLevelCount(width, height);
+    texdesc.storageMode      = MTLStorageModeManaged;
+    texdesc.usage            = MTLTextureUsageShaderRead;
+    if (cache_ != nil)
+    {
+      filterTex_[index] = [[cache_ uniqueTextureWithDescriptor:texdesc] retain];
+    }
+    else
+    {
+      filterTex_[index] = [texObj.device newTextureWithDescriptor:texdesc];
+    }
+    [texdesc release];
+  }
+  return filterTex_[index];
+}
+
+//
+- (void)setImageFilter:(std::shared_ptr<ImageFilter::Graph>)graph
+{
+  imageFilter_ = std::move(graph);
+  if (!imageFilter_ || texObj == nil)
+  {
+    [self releaseFilterTexture];
+    return;
+  }
+
+  // 元のテクスチャは共有されているので出力先は別に用意する(applyImageFilterで作る)
+  auto                 width  = texObj.width;
+  auto                 height = texObj.height;
+  std::vector<uint8_t> pixels(width * height * 4);
+  [texObj getBytes:pixels.data()
+       bytesPerRow:width * 4
+        fromRegion:MTLRegionMake2D(0, 0, width, height)
+       mipmapLevel:0];
+  // sRGBのテクスチャはリニアに戻してからフィルタを掛ける
+  auto srgb = texObj.pixelFormat == MTLPixelFormatRGBA8Unorm_sRGB;
+  imageFilter_->setSource(pixels.data(), width, height, width * 4, srgb);
+}
+
+// ソースかパラメータが変わった時だけ再計算して転送する
+// 前のフレームが読んでいるかもしれないので、毎回次の出力先に書き込んでそちらに切り替える
+- (BOOL)applyImageFilter
+{
+  if (!imageFilter_ || texObj == nil || !imageFilter_->process())
+  {
+    return NO;
+  }
+
+  auto next      = (filterIndex_ + 1) % FilterTextureCount;
+  auto filterTex = [self filterTextureAt:next];
+
+  auto width  = imageFilter_->width();
+  auto height = imageFilter_->height();
+  auto pixels = imageFilter_->output();
+  auto stride = imageFilter_->outputBytesPerRow();
+  [filterTex replaceRegion:MTLRegionMake2D(0, 0, width, height)
+               mipmapLevel:0
+                 withBytes:pixels
+               bytesPerRow:stride];
+
+  auto srgb = filterTex.pixelFormat == MTLPixelFormatRGBA8Unorm_sRGB;
+  auto mips = ImageDownsample::BuildMipChain(pixels, width, height, stride, srgb);
+  for (NSUInteger level = 1; level <= mips.size() && level < filterTex.mipmapLevelCount; level++)
+  {
+    const auto &mip = mips[level - 1];
+    [filterTex replaceRegion:MTLRegionMake2D(0, 0, mip.width, mip.height)
+                 mipmapLevel:level
+                   withBytes:mip.pixels.data()
+                 bytesPerRow:mip.bytesPerRow];
+  }
+  filterIndex_ = next;
+  return YES;
+}
+
 //
 - (const SprPosList &)update
 {
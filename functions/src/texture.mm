@@ -2,6 +2,7 @@
 // Copyright 2024 Y.Suzuki(wave.suzuki.z@gmail.com)
 //
 #import "texture.h"
+#include "image_downsample.h"
 #import <CoreImage/CoreImage.h>
 #import <MetalKit/MetalKit.h>
 
@@ -23,21 +24,34 @@
 
 - (void)buildTexture:(CGContextRef)ctx
 {
-  width        = CGBitmapContextGetWidth(ctx);
-  height       = CGBitmapContextGetHeight(ctx);
-  auto *bitmap = static_cast<uint8_t *>(CGBitmapContextGetData(ctx));
+  width         = CGBitmapContextGetWidth(ctx);
+  height        = CGBitmapContextGetHeight(ctx);
+  auto *bitmap  = static_cast<uint8_t *>(CGBitmapContextGetData(ctx));
+  auto  rowSize = CGBitmapContextGetBytesPerRow(ctx);
 
-  auto texdesc        = [[MTLTextureDescriptor alloc] init];
-  texdesc.width       = width;
-  texdesc.height      = height;
-  texdesc.pixelFormat = MTLPixelFormatRGBA8Unorm;
-  texdesc.textureType = MTLTextureType2D;
-  texdesc.storageMode = MTLStorageModeManaged;
-  texdesc.usage       = MTLTextureUsageShaderRead;
+  // 縮小表示用のミップマップ
+  auto mips = ImageDownsample::BuildMipChain(bitmap, width, height, rowSize, false);
+
+  auto texdesc             = [[MTLTextureDescriptor alloc] init];
+  texdesc.width            = width;
+  texdesc.height           = height;
+  texdesc.pixelFormat      = MTLPixelFormatRGBA8Unorm;
+  texdesc.textureType      = MTLTextureType2D;
+  texdesc.mipmapLevelCount = mips.size() + 1;
+  texdesc.storageMode      = MTLStorageModeManaged;
+  texdesc.usage            = MTLTextureUsageShaderRead;
 
   auto region = MTLRegionMake2D(0, 0, width, height);
   object      = [device_ newTextureWithDescriptor:texdesc];
-  [object replaceRegion:region mipmapLevel:0 withBytes:bitmap bytesPerRow:width * 4];
+  [object replaceRegion:region mipmapLevel:0 withBytes:bitmap bytesPerRow:rowSize];
+  for (NSUInteger level = 1; level <= mips.size(); level++)
+  {
+    const auto &mip = mips[level - 1];
+    [object replaceRegion:MTLRegionMake2D(0, 0, mip.width, mip.height)
+              mipmapLevel:level
+                withBytes:mip.pixels.data()
+              bytesPerRow:mip.bytesPerRow];
+  }
   [texdesc release];
 }
 
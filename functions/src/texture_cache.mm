@@ -0,0 +1,374 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#import "texture_cache.h"
+#include "asset_archive.h"
+#include "dsemaphore.h"
+#include "image_decode.h"
+#include "image_downsample.h"
+#import <Metal/Metal.h>
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+constexpr NSUInteger DefaultBudget = 256 * 1024 * 1024;
+
+struct CacheEntry
+{
+  id<MTLTexture>                    texture_ = nil;
+  std::string                       key_;
+  NSUInteger                        bytes_    = 0;
+  int                               refCount_ = 0;
+  bool                              inLRU_    = false;
+  std::list<CacheEntry *>::iterator lru_;
+
+  ~CacheEntry() { [texture_ release]; }
+};
+using CacheEntryPtr = std::unique_ptr<CacheEntry>;
+
+} // namespace
+
+@implementation TextureCache
+{
+  id<MTLDevice> device_;
+
+  AssetArchive::Reader archive_;
+
+  std::unordered_map<void *, CacheEntryPtr>     entries_;
+  std::unordered_map<std::string, CacheEntry *> keyMap_;
+  std::list<CacheEntry *>                       lruList_; // 先頭が最も古い
+
+  NSUInteger bytesTotal_;
+  NSUInteger bytesCached_;
+  NSUInteger bytesTransient_;
+  NSUInteger hits_;
+  NSUInteger misses_;
+  NSUInteger evictions_;
+  NSUInteger lastHits_;
+  NSUInteger lastMisses_;
+  NSUInteger lastEvictions_;
+
+  SimpleLock lock_;
+}
+
+@synthesize budget;
+
+- (nonnull instancetype)initWithDevice:(nonnull id<MTLDevice>)device
+{
+  self = [super init];
+  if (self != nil)
+  {
+    device_         = device;
+    budget          = DefaultBudget;
+    bytesTotal_     = 0;
+    bytesCached_    = 0;
+    bytesTransient_ = 0;
+    hits_           = 0;
+    misses_         = 0;
+    evictions_      = 0;
+    lastHits_       = 0;
+    lastMisses_     = 0;
+    lastEvictions_  = 0;
+
+    // パック済みアーカイブがあれば優先して使う
+    if (auto path = [[NSBundle mainBundle] pathForResource:@"assets" ofType:@"pak"])
+    {
+      if (!archive_.open(path.fileSystemRepresentation))
+      {
+        NSLog(@"Couldn't open asset archive: %@", path);
+      }
+    }
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  lruList_.clear();
+  keyMap_.clear();
+  entries_.clear();
+  [super dealloc];
+}
+
+// バンドル内の実体パスとパラメータでキーを作る
++ (std::string)keyForFile:(NSURL *)url
+{
+  auto path = url.URLByStandardizingPath.URLByResolvingSymlinksInPath.path;
+  return std::string{path.UTF8String} + "?srgb=1&mip=1";
+}
+
+// 予算を超えていたら未参照のものを破棄(lock_保持中に呼ぶ)
+- (void)evict
+{
+  while (bytesTotal_ + bytesTransient_ > budget && !lruList_.empty())
+  {
+    auto *entry = lruList_.front();
+    lruList_.pop_front();
+    bytesTotal_ -= entry->bytes_;
+    bytesCached_ -= entry->bytes_;
+    evictions_++;
+    keyMap_.erase(entry->key_);
+    entries_.erase((__bridge void *)entry->texture_);
+  }
+}
+
+- (CacheEntry *)addEntry:(id<MTLTexture>)texture key:(std::string)key
+{
+  auto entry       = std::make_unique<CacheEntry>();
+  entry->texture_  = texture;
+  entry->key_      = std::move(key);
+  entry->bytes_    = texture.allocatedSize;
+  entry->refCount_ = 1;
+  bytesTotal_ += entry->bytes_;
+
+  auto *ptr = entry.get();
+  if (!ptr->key_.empty())
+  {
+    keyMap_[ptr->key_] = ptr;
+  }
+  entries_[(__bridge void *)texture] = std::move(entry);
+  [self evict];
+  return ptr;
+}
+
+// lock_保持中に呼ぶ
+- (id<MTLTexture>)acquireEntry:(CacheEntry *)entry
+{
+  if (entry->inLRU_)
+  {
+    lruList_.erase(entry->lru_);
+    entry->inLRU_ = false;
+    bytesCached_ -= entry->bytes_;
+  }
+  entry->refCount_++;
+  return entry->texture_;
+}
+
+// デコードした画像からミップマップを生成して転送する
+- (nullable id<MTLTexture>)newTextureFromImage:(const ImageDownsample::Image &)image
+{
+  auto mips = ImageDownsample::BuildMipChain(
+      image.pixels.data(), image.width, image.height, image.bytesPerRow, true);
+
+  auto texdesc             = [[MTLTextureDescriptor alloc] init];
+  texdesc.width            = image.width;
+  texdesc.height           = image.height;
+  texdesc.pixelFormat      = MTLPixelFormatRGBA8Unorm_sRGB;
+  texdesc.textureType      = MTLTextureType2D;
+  texdesc.mipmapLevelCount = mips.size() + 1;
+  texdesc.storageMode      = MTLStorageModeManaged;
+  texdesc.usage            = MTLTextureUsageShaderRead;
+
+  auto texture = [device_ newTextureWithDescriptor:texdesc];
+  [texdesc release];
+
+  [texture replaceRegion:MTLRegionMake2D(0, 0, image.width, image.height)
+             mipmapLevel:0
+               withBytes:image.pixels.data()
+             bytesPerRow:image.bytesPerRow];
+  for (NSUInteger level = 1; level <= mips.size(); level++)
+  {
+    const auto &mip = mips[level - 1];
+    [texture replaceRegion:MTLRegionMake2D(0, 0, mip.width, mip.height)
+               mipmapLevel:level
+                 withBytes:mip.pixels.data()
+               bytesPerRow:mip.bytesPerRow];
+  }
+  return texture;
+}
+
+// マッピングから直接転送する(デコード不要)
+- (nullable id<MTLTexture>)newTextureFromArchive:(const AssetArchive::ArchiveEntry &)entry
+{
+  auto pixelFormat = entry.format == (uint32_t)AssetArchive::PixelFormat::RGBA8Unorm
+                         ? MTLPixelFormatRGBA8Unorm
+                         : MTLPixelFormatRGBA8Unorm_sRGB;
+
+  auto texdesc             = [[MTLTextureDescriptor alloc] init];
+  texdesc.width            = entry.width;
+  texdesc.height           = entry.height;
+  texdesc.pixelFormat      = pixelFormat;
+  texdesc.textureType      = MTLTextureType2D;
+  texdesc.mipmapLevelCount = entry.mipLevels;
+  texdesc.storageMode      = MTLStorageModeManaged;
+  texdesc.usage            = MTLTextureUsageShaderRead;
+
+  auto texture = [device_ newTextureWithDescriptor:texdesc];
+  [texdesc release];
+
+  for (uint32_t level = 0; level < entry.mipLevels; level++)
+  {
+    auto image = archive_.getLevel(entry, level);
+    if (image.data == nullptr)
+    {
+      [texture release];
+      return nil;
+    }
+    auto region = MTLRegionMake2D(0, 0, image.width, image.height);
+    [texture replaceRegion:region
+               mipmapLevel:level
+                 withBytes:image.data
+               bytesPerRow:image.bytesPerRow];
+  }
+  return texture;
+}
+
+//
+- (nullable id<MTLTexture>)textureWithFile:(nonnull NSString *)fname
+{
+  std::string key;
+  NSURL      *fURL  = nil;
+  auto       *entry = archive_.find(fname.UTF8String);
+  if (entry != nullptr)
+  {
+    key = std::string{"pak:"} + fname.UTF8String + "?srgb=1&mip=1";
+  }
+  else
+  {
+    fURL = [[NSBundle mainBundle] URLForResource:fname withExtension:nil];
+    if (fURL == nil)
+    {
+      NSLog(@"Couldn't find texture file: %@", fname);
+      return nil;
+    }
+    key = [TextureCache keyForFile:fURL];
+  }
+
+  {
+    SimpleGuard guard{lock_};
+    if (auto it = keyMap_.find(key); it != keyMap_.end())
+    {
+      hits_++;
+      return [self acquireEntry:it->second];
+    }
+    misses_++;
+  }
+
+  id<MTLTexture> texture = nil;
+  if (entry != nullptr)
+  {
+    texture = [self newTextureFromArchive:*entry];
+  }
+  else
+  {
+    ImageDownsample::Image image;
+    if (DecodeImageFile(fURL.fileSystemRepresentation, 4, image))
+    {
+      texture = [self newTextureFromImage:image];
+    }
+    else
+    {
+      NSLog(@"Couldn't load texture: %@", fname);
+    }
+  }
+  if (texture == nil)
+  {
+    return nil;
+  }
+
+  SimpleGuard guard{lock_};
+  if (auto it = keyMap_.find(key); it != keyMap_.end())
+  {
+    // 別スレッドが先に読み込んだ
+    [texture release];
+    return [self acquireEntry:it->second];
+  }
+  return [self addEntry:texture key:std::move(key)]->texture_;
+}
+
+//
+- (nullable id<MTLTexture>)uniqueTextureWithDescriptor:(nonnull MTLTextureDescriptor *)desc
+{
+  auto texture = [device_ newTextureWithDescriptor:desc];
+  if (texture == nil)
+  {
+    return nil;
+  }
+
+  SimpleGuard guard{lock_};
+  return [self addEntry:texture key:std::string{}]->texture_;
+}
+
+//
+- (void)releaseTexture:(nullable id<MTLTexture>)texture
+{
+  if (texture == nil)
+  {
+    return;
+  }
+
+  SimpleGuard guard{lock_};
+  auto        it = entries_.find((__bridge void *)texture);
+  if (it == entries_.end())
+  {
+    return;
+  }
+
+  auto *entry = it->second.get();
+  if (--entry->refCount_ > 0)
+  {
+    return;
+  }
+
+  if (entry->key_.empty())
+  {
+    // 共有しないものはすぐ破棄
+    bytesTotal_ -= entry->bytes_;
+    entries_.erase(it);
+    return;
+  }
+
+  entry->lru_   = lruList_.insert(lruList_.end(), entry);
+  entry->inLRU_ = true;
+  bytesCached_ += entry->bytes_;
+  [self evict];
+}
+
+//
+- (void)addTransientBytes:(NSUInteger)bytes
+{
+  SimpleGuard guard{lock_};
+  bytesTransient_ += bytes;
+  [self evict];
+}
+
+- (void)removeTransientBytes:(NSUInteger)bytes
+{
+  SimpleGuard guard{lock_};
+  bytesTransient_ -= std::min(bytes, bytesTransient_);
+}
+
+//
+- (TextureCacheStats)stats
+{
+  SimpleGuard       guard{lock_};
+  TextureCacheStats stats;
+  stats.textureCount   = entries_.size();
+  stats.bytesInUse     = bytesTotal_ - bytesCached_;
+  stats.bytesCached    = bytesCached_;
+  stats.bytesTransient = bytesTransient_;
+  stats.budget         = budget;
+  stats.hits           = lastHits_;
+  stats.misses         = lastMisses_;
+  stats.evictions      = lastEvictions_;
+  return stats;
+}
+
+// フレーム単位の統計を確定
+- (void)endFrame
+{
+  SimpleGuard guard{lock_};
+  [self evict];
+  lastHits_      = hits_;
+  lastMisses_    = misses_;
+  lastEvictions_ = evictions_;
+  hits_          = 0;
+  misses_        = 0;
+  evictions_     = 0;
+}
+
+@end
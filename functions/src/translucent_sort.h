@@ -0,0 +1,93 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "parallel_for.h"
+#include "radix_sort.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <simd/simd.h>
+#include <vector>
+
+//
+// 半透明の三角形を奥から順に並べ替える(Draw3Dで使用)
+// 重心のビュー空間のzをキーにして基数ソートし、その順に頂点を書き出す
+// 頂点はposition(simd_float3)を持つ型(VertexDataPrim3D)で、3つずつで1つの三角形
+//
+namespace Translucent
+{
+
+struct DepthKey
+{
+  uint32_t key;
+  uint32_t index;
+};
+
+// floatの大小とuint32の大小を一致させる
+inline uint32_t DepthOrder(float z)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &z, sizeof(bits));
+  return bits ^ ((bits >> 31) != 0 ? 0xffffffffu : 0x80000000u);
+}
+
+//
+class Sorter
+{
+  std::vector<DepthKey> keys_;
+  std::vector<DepthKey> temp_;
+
+public:
+  // row: モデルビュー行列のzの行。zは3倍のままでも順序は変わらない(奥ほど小さい)
+  template <class Vertex>
+  void buildKeys(const Vertex *src, size_t nbTriangles, simd_float4 row)
+  {
+    keys_.resize(nbTriangles);
+    ParallelFor(nbTriangles,
+                4096,
+                [&](size_t begin, size_t end)
+                {
+                  for (size_t i = begin; i < end; i++)
+                  {
+                    const auto *tri    = src + i * 3;
+                    auto        center = tri[0].position + tri[1].position + tri[2].position;
+                    float       z      = simd_dot(row.xyz, center) + row.w * 3.0f;
+                    keys_[i]           = {DepthOrder(z), uint32_t(i)};
+                  }
+                });
+  }
+
+  void sortKeys()
+  {
+    ParallelRadixSort(keys_, temp_, [](const DepthKey &k) { return uint64_t(k.key); });
+  }
+
+  // 並べ替えた順にdstへ書き出す(srcとdstは重ならないこと)
+  template <class Vertex>
+  void scatter(const Vertex *src, Vertex *dst) const
+  {
+    ParallelFor(keys_.size(),
+                4096,
+                [&](size_t begin, size_t end)
+                {
+                  for (size_t i = begin; i < end; i++)
+                  {
+                    std::memcpy(dst + i * 3, src + keys_[i].index * 3, sizeof(Vertex) * 3);
+                  }
+                });
+  }
+
+  template <class Vertex>
+  void sort(const Vertex *src, size_t nbTriangles, simd_float4 row, Vertex *dst)
+  {
+    buildKeys(src, nbTriangles, row);
+    sortKeys();
+    scatter(src, dst);
+  }
+
+  [[nodiscard]] const std::vector<DepthKey> &keys() const { return keys_; }
+};
+
+} // namespace Translucent
@@ -0,0 +1,61 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "shader_def.h"
+
+#include <metal_stdlib>
+using namespace metal;
+
+struct particleOut
+{
+    float4 pos [[position]];
+    half4 color;
+    float2 offset; // 中心からの位置(-1..1)
+};
+
+// 四角形の角(ストリップ順の0,1,2,2,1,3を2bitずつ詰めたもの)
+// 3Dでは反時計回りが表になるように並べる
+static float2 particleCorner(uint vID)
+{
+    uint corner = (0xDA4u >> ((vID % 6) * 2)) & 3;
+    return float2(corner & 1 ? 1.0 : -1.0, corner & 2 ? 1.0 : -1.0);
+}
+
+vertex particleOut particleVert3d(const device ParticleData* particles [[buffer(0)]],
+                                  const device Uniforms& cameraData [[buffer(1)]],
+                                  constant ParticleBasis& basis [[buffer(2)]],
+                                  uint vID [[vertex_id]])
+{
+    const device ParticleData& pd = particles[vID / 6];
+    float2 corner = particleCorner(vID);
+    float3 wpos   = pd.position + (basis.right * corner.x + basis.up * corner.y) * (pd.size * 0.5);
+
+    particleOut out;
+    out.pos    = cameraData.perspectiveTransform * cameraData.worldTransform * float4(wpos, 1.0);
+    out.color  = pd.color;
+    out.offset = corner;
+    return out;
+}
+
+vertex particleOut particleVert2d(const device ParticleData* particles [[buffer(0)]],
+                                  const device Uniforms2D* screenData [[buffer(1)]],
+                                  uint vID [[vertex_id]])
+{
+    const device ParticleData& pd = particles[vID / 6];
+    float2 corner = particleCorner(vID);
+    float2 ppos   = pd.position.xy + corner * (pd.size * 0.5);
+    float2 pos    = float2(ppos.x, screenData->size.y - ppos.y);
+
+    particleOut out;
+    out.pos    = float4(pos / screenData->size * 2.0 - 1.0, 0.0, 1.0);
+    out.color  = pd.color;
+    out.offset = corner;
+    return out;
+}
+
+// 縁に向かって薄くなる円
+fragment half4 particleFrag(particleOut in [[stage_in]])
+{
+    half fade = saturate(1.0h - half(length(in.offset)));
+    return half4(in.color.rgb, in.color.a * fade);
+}
@@ -26,6 +26,21 @@ vertex p2f primVert2d(const device VertexDataPrim2D* vertexArray [[buffer(0)]],c
     return out;
 }
 
+// DisplayList用: 記録済みの頂点を変換して描画する
+vertex p2f listVert2d(const device VertexDataPrim2D* vertexArray [[buffer(0)]],const device Uniforms2D* screenData [[buffer(1)]], constant ListInstance2D& instance [[buffer(2)]], unsigned int vID [[vertex_id]])
+{
+    const device VertexDataPrim2D& vd2d = vertexArray[vID];
+
+    float2 tpos = instance.transform * float3(vd2d.position, 1.0);
+    float2 pos  = float2(tpos.x, screenData->size.y - tpos.y);
+
+    p2f out;
+    out.pos      = float4(pos / screenData->size * 2.0 - 1.0, 0.0, 1.0);
+    out.color    = half4(vd2d.color.rgba) * half4(instance.color);
+
+    return out;
+}
+
 fragment half4 primFrag2d(p2f in [[stage_in]])
 {
     return in.color;
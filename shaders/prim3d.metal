@@ -30,6 +30,23 @@ vertex v2f primVert3d( device const VertexDataPrim3D* vertexData [[buffer(0)]],
     return o;
 }
 
+// Mesh3D(インスタンス毎のモデル行列)
+vertex v2f meshVert3d( device const VertexDataPrim3D* vertexData [[buffer(0)]],
+                       device const Uniforms& cameraData [[ buffer(1)]],
+                       constant MeshInstance3D& instance [[ buffer(2)]],
+                       uint vID [[vertex_id]])
+{
+    v2f o;
+
+    const device VertexDataPrim3D& vd = vertexData[ vID ];
+    float4 pos = instance.model * float4( vd.position, 1.0 );
+    pos = cameraData.perspectiveTransform * cameraData.worldTransform * pos;
+    o.position = pos;
+    o.color = vd.color * half4( instance.color );
+
+    return o;
+}
+
 fragment half4 primFrag3d( v2f in [[stage_in]] )
 {
     return in.color;
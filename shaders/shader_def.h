@@ -47,6 +47,20 @@ typedef struct
   simd_float2 size;
 } Uniforms2D;
 
+// DisplayList再生時の変換(ピクセル座標へのアフィン変換)と乗算カラー
+typedef struct
+{
+  simd_float3x2 transform;
+  simd_float4   color;
+} ListInstance2D;
+
+// Mesh3D描画時のモデル行列と乗算カラー
+typedef struct
+{
+  matrix_float4x4 model;
+  simd_float4     color;
+} MeshInstance3D;
+
 struct VertexDataPrim2D
 {
   simd_float2 position;
@@ -67,6 +81,25 @@ struct VertexDataPrim3D
 #endif
 };
 
+// パーティクル1粒子分(頂点シェーダーで6頂点の四角形に展開する)
+struct ParticleData
+{
+  simd_float3 position;
+  float       size;
+#ifdef __METAL_VERSION__
+  half4 color;
+#else
+  float16x4_t color;
+#endif
+};
+
+// 3Dパーティクルの四角形を張る軸(カメラのビュー基底)
+typedef struct
+{
+  simd_float3 right;
+  simd_float3 up;
+} ParticleBasis;
+
 struct VertexData3D
 {
   simd_float3 position;
@@ -23,16 +23,17 @@ vertex p2f vert2d(const device VertexDataPrim2D* vertexArray [[buffer(0)]],const
     p2f out;
     out.pos        = float4(pos / screenData->size * 2.0 - 1.0, 0.0, 1.0);
     out.color      = vd2d.color;
-    // テクスチャUVは自動
-    out.texcoord.x = vID & 1 ? 0 : 1;
-    out.texcoord.y = vID & 2 ? 1 : 0;
+    // テクスチャUVは自動(四角形毎に6頂点: ストリップ順の0,1,2,2,1,3を2bitずつ詰めたもの)
+    uint corner    = (0xDA4u >> ((vID % 6) * 2)) & 3;
+    out.texcoord.x = corner & 1 ? 0 : 1;
+    out.texcoord.y = corner & 2 ? 1 : 0;
 
     return out;
 }
 
 fragment half4 frag2d(p2f in [[stage_in]], texture2d<half, access::sample> tex [[texture(0)]] )
 {
-    constexpr sampler s( address::repeat, filter::linear );
+    constexpr sampler s( address::repeat, filter::linear, mip_filter::linear );
     half4 texel = tex.sample( s, in.texcoord ).rgba;
     return in.color * texel;
 }
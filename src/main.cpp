@@ -10,9 +10,13 @@
 #include <format>
 #include <game_pad.h>
 #include <iostream>
+#include <iterator>
 #include <keyboard.h>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
+#include <particle_system.h>
+#include <scene_graph.h>
 #include <simd/quaternion.h>
 #include <simd/vector_make.h>
 #include <sprite4cpp.h>
@@ -38,7 +42,12 @@ class MainLoop : public ApplicationLoop
   bool              onKeyD_      = false;
   uint64_t          updateCount_ = 0;
 
-  std::shared_ptr<SpriteCpp> sprite_;
+  std::shared_ptr<SpriteCpp>          sprite_;
+  ApplicationContext::DisplayListPtr padFrame_;
+  std::unique_ptr<Particle::System>  fountain_;
+  ApplicationContext::MeshPtr        cube_;
+  Scene::Graph                       scene_;
+  std::array<Scene::NodeId, 3>       orbit_{};
 
   std::mutex padLock_;
 
@@ -103,6 +112,8 @@ public:
     {
       sprite_.reset();
     }
+    padFrame_.reset();
+    cube_.reset();
     std::cout << std::format("To Close Window\n");
   }
 
@@ -142,17 +153,21 @@ public:
           }
         });
 
-    static int cnt   = 0;
-    auto       hello = std::format("こんにちは({:.2f}): {}", ctx.ContentScale(), cnt);
+    // 毎フレームの文字列はフレーム領域に作る
+    static int       cnt = 0;
+    std::pmr::string hello{ctx.GetFrameAllocator()};
+    std::format_to(std::back_inserter(hello), "こんにちは({:.2f}): {}", ctx.ContentScale(), cnt);
     ctx.Print(hello.c_str(), 200, 200);
     ctx.DrawRect({190, 190}, {600, 230}, {0, 1, 0, 1});
 
     if (updateCount_ > 10)
     {
-      auto diffTime  = lastUpdateTime_ - connectTime_;
-      auto secNum    = diffTime / (1000.0 * 1000.0 * 1000.0);
-      auto upRate    = (double)updateCount_ / secNum;
-      auto upRateStr = std::format("{:.3f}/{}/{:.1f}", upRate, updateCount_, secNum);
+      auto             diffTime = lastUpdateTime_ - connectTime_;
+      auto             secNum   = diffTime / (1000.0 * 1000.0 * 1000.0);
+      auto             upRate   = (double)updateCount_ / secNum;
+      std::pmr::string upRateStr{ctx.GetFrameAllocator()};
+      std::format_to(
+          std::back_inserter(upRateStr), "{:.3f}/{}/{:.1f}", upRate, updateCount_, secNum);
       ctx.Print(upRateStr.c_str(), 200, 240);
     }
 
@@ -161,7 +176,11 @@ public:
     auto  tgt  = simd_make_float2(std::sinf(deg), std::cosf(deg));
     tgt        = base + tgt * 100.0f;
 
+    // 枠の外にはみ出した部分は描画されない
+    ctx.DrawRect(base - 80.0f, base + 80.0f, {0.5, 0.5, 0.5, 1});
+    ctx.PushClipRect(base - 80.0f, base + 80.0f);
     ctx.DrawLine(base, tgt, {1, 1, 1, 1});
+    ctx.PopClipRect();
 
     {
       // test 3D
@@ -175,10 +194,9 @@ public:
       auto p1 = simd_make_float3(-5.0f, 0.0f, 5.0f);
       auto p2 = simd_make_float3(-5.0f, 0.0f, -5.0f);
       auto p3 = simd_make_float3(5.0f, 0.0f, -5.0f);
-      ctx.DrawLine3D(p0, p1, {1, 1, 1, 1});
-      ctx.DrawLine3D(p1, p2, {1, 1, 1, 1});
-      ctx.DrawLine3D(p2, p3, {1, 1, 1, 1});
-      ctx.DrawLine3D(p3, p0, {1, 1, 1, 1});
+      simd_float4  white   = {1, 1, 1, 1};
+      const Line3D frame[] = {{p0, p1, white}, {p1, p2, white}, {p2, p3, white}, {p3, p0, white}};
+      ctx.DrawLines3D(frame);
       ctx.DrawPlane3D(p0, p1, p2, p3, {0.1, 0.1, 0.5, 1});
       float deg2 = (((cnt + 120) % 360) / 360.0f) * M_PI * 2.0f;
       float deg3 = (((cnt + 240) % 360) / 360.0f) * M_PI * 2.0f;
@@ -186,6 +204,98 @@ public:
       auto  tp1  = simd_make_float3(std::sinf(deg2), 1.0f, std::cosf(deg2));
       auto  tp2  = simd_make_float3(std::sinf(deg3), 1.0f, std::cosf(deg3));
       ctx.DrawTriangle3D(tp0, tp1, tp2, {1, 0, 0, 1});
+
+      // particle
+      if (!fountain_)
+      {
+        Particle::EmitterDesc desc;
+        desc.position       = simd_make_float3(-3.0f, 0.0f, -3.0f);
+        desc.positionSpread = simd_make_float3(0.1f, 0.0f, 0.1f);
+        desc.velocity       = simd_make_float3(0.0f, 6.0f, 0.0f);
+        desc.velocitySpread = simd_make_float3(1.0f, 1.0f, 1.0f);
+        desc.rate           = 20000.0f;
+        desc.lifeMin        = 1.5f;
+        desc.lifeMax        = 2.5f;
+        desc.sizeStart      = 0.15f;
+        desc.sizeEnd        = 0.02f;
+
+        Particle::Forces forces;
+        forces.gravity = simd_make_float3(0.0f, -9.8f, 0.0f);
+        forces.drag    = 0.2f;
+
+        Particle::ColorCurve curve({0.4f, 0.7f, 1.0f, 1.0f}, {0.1f, 0.2f, 1.0f, 0.0f});
+        curve.addKey(0.5f, {1.0f, 1.0f, 1.0f, 0.8f});
+
+        fountain_ = std::make_unique<Particle::System>(100000);
+        fountain_->setEmitter(desc);
+        fountain_->setForces(forces);
+        fountain_->setColorCurve(curve);
+      }
+      fountain_->update(1.0f / 60.0f);
+      ctx.DrawParticles3D(*fountain_);
+
+      // 階層(太陽→惑星→衛星)
+      if (!cube_)
+      {
+        cube_ = ctx.CreateMesh();
+        const simd_float3 v[] = {{-0.5f, -0.5f, -0.5f},
+                                 {0.5f, -0.5f, -0.5f},
+                                 {0.5f, 0.5f, -0.5f},
+                                 {-0.5f, 0.5f, -0.5f},
+                                 {-0.5f, -0.5f, 0.5f},
+                                 {0.5f, -0.5f, 0.5f},
+                                 {0.5f, 0.5f, 0.5f},
+                                 {-0.5f, 0.5f, 0.5f}};
+
+        const int faces[6][4] = {
+            {0, 1, 2, 3}, {5, 4, 7, 6}, {4, 0, 3, 7}, {1, 5, 6, 2}, {3, 2, 6, 7}, {4, 5, 1, 0}};
+        for (int f = 0; f < 6; f++)
+        {
+          float shade = 0.6f + f * 0.08f;
+          cube_->DrawPlane(v[faces[f][0]],
+                           v[faces[f][1]],
+                           v[faces[f][2]],
+                           v[faces[f][3]],
+                           {shade, shade, shade, 1.0f});
+        }
+
+        Scene::Transform sun;
+        sun.position = simd_make_float3(3.0f, 1.5f, 3.0f);
+        Scene::Transform planet;
+        planet.position = simd_make_float3(2.0f, 0.0f, 0.0f);
+        planet.scale    = simd_make_float3(0.5f, 0.5f, 0.5f);
+        Scene::Transform moon;
+        moon.position = simd_make_float3(1.5f, 0.0f, 0.0f);
+        moon.scale    = simd_make_float3(0.4f, 0.4f, 0.4f);
+        orbit_[0]     = scene_.create(Scene::InvalidNode, sun);
+        orbit_[1]     = scene_.create(orbit_[0], planet);
+        orbit_[2]     = scene_.create(orbit_[1], moon);
+      }
+      auto axisY = simd_make_float3(0.0f, 1.0f, 0.0f);
+      scene_.setRotation(orbit_[0], simd_quaternion(deg, axisY));
+      scene_.setRotation(orbit_[1], simd_quaternion(deg * 3.0f, axisY));
+      scene_.update();
+      ctx.DrawMesh(cube_, scene_, orbit_[0], {1.0f, 0.8f, 0.2f, 1.0f});
+      ctx.DrawMesh(cube_, scene_, orbit_[1], {0.3f, 0.6f, 1.0f, 1.0f});
+      ctx.DrawMesh(cube_, scene_, orbit_[2], {0.8f, 0.8f, 0.8f, 1.0f});
+
+      // 3Dの位置に名前を重ねる
+      static const char         *names[] = {"sun", "planet", "moon"};
+      std::array<simd_float3, 3> centers;
+      std::array<simd_float2, 3> labels;
+      std::array<uint8_t, 3>     visible;
+      for (size_t i = 0; i < orbit_.size(); i++)
+      {
+        centers[i] = scene_.world(orbit_[i]).columns[3].xyz;
+      }
+      ctx.ProjectToScreen(centers, labels, visible);
+      for (size_t i = 0; i < labels.size(); i++)
+      {
+        if (visible[i])
+        {
+          ctx.Print(names[i], labels[i].x, labels[i].y);
+        }
+      }
     }
 
     auto &pad = padStateUpdate_;
@@ -212,10 +322,35 @@ public:
       auto tp0 = simd_act(rotQ, simd_make_float3(0.0f, 0.0f, 1.0f)) + tpos;
       auto tp1 = simd_act(rotQ, simd_make_float3(1.0f, 0.0f, 0.0f)) + tpos;
       auto tp2 = simd_act(rotQ, simd_make_float3(-1.0f, 0.0f, 0.0f)) + tpos;
-      ctx.DrawTriangle3D(tp0, tp1, tp2, {1, 1, 0, 1});
+      ctx.DrawTriangle3D(tp0, tp1, tp2, {1, 1, 0, 0.6});
 
       std::array<bool, 11> btn{};
 
+      // 枠は変化しないので一度だけ記録する
+      if (!padFrame_)
+      {
+        padFrame_ = ctx.CreateDisplayList();
+        for (float xofs : {0.0f, 70.0f})
+        {
+          for (int i = 0; i < btn.size(); i++)
+          {
+            auto p1 = simd_make_float2(1200 + xofs, 100 + i * 60);
+            auto p2 = simd_make_float2(1250 + xofs, 150 + i * 60);
+            padFrame_->DrawRect(p1, p2, {1, 1, 1, 1});
+          }
+        }
+        for (auto dp : {simd_make_float2(900, 500),
+                        simd_make_float2(1000, 500),
+                        simd_make_float2(950, 450),
+                        simd_make_float2(950, 550)})
+        {
+          padFrame_->DrawRect(dp - 20, dp + 20, {1, 1, 1, 1});
+        }
+        padFrame_->DrawPolygon({300, 500}, 100, 0, 20, {1, 1, 1, 1});
+        padFrame_->DrawPolygon({650, 500}, 100, 0, 20, {1, 0.5, 0.5, 1});
+      }
+      ctx.DrawDisplayList(padFrame_, simd_make_float2(0, 0));
+
       auto color    = simd_make_float4(0, 1, 0, 1);
       auto drawBtns = [&](float xofs)
       {
@@ -224,7 +359,6 @@ public:
         {
           auto p1 = simd_make_float2(1200 + xofs, y + i * 60);
           auto p2 = simd_make_float2(1250 + xofs, y + 50 + i * 60);
-          ctx.DrawRect(p1, p2, {1, 1, 1, 1});
           if (btn[i])
           {
             ctx.FillRect(p1, p2, color);
@@ -261,7 +395,6 @@ public:
       {
         auto p1 = simd_make_float2(x - 20, y - 20);
         auto p2 = simd_make_float2(x + 20, y + 20);
-        ctx.DrawRect(p1, p2, {1, 1, 1, 1});
         if (val)
         {
           p1 += 2;
@@ -294,7 +427,6 @@ public:
       {
         ctx.FillPolygon(anbase, 80, 0, 20, {1.0f, 0.9f, 0.0f, 0.3f});
       }
-      ctx.DrawPolygon(anbase, 100, 0, 20, {1, 1, 1, 1});
       auto an0pos = simd_make_float2(pad.leftX, -pad.leftY) * 100 + anbase;
       ctx.DrawLine(anbase, an0pos, {0, 1, 0, 1});
 
@@ -303,7 +435,6 @@ public:
       {
         ctx.FillPolygon(anbase, 80, 0, 20, {1.0f, 0.9f, 0.0f, 0.3f});
       }
-      ctx.DrawPolygon(anbase, 100, 0, 20, {1, 0.5, 0.5, 1});
       auto an1pos = simd_make_float2(pad.rightX, -pad.rightY) * 100 + anbase;
       ctx.DrawLine(anbase, an1pos, {0, 1, 0, 1});
 
@@ -322,9 +453,10 @@ public:
       xaxs      = simd_act(posture, xaxs) + center;
       yaxs      = simd_act(posture, yaxs) + center;
       zaxs      = simd_act(posture, zaxs) + center;
-      ctx.DrawLine3D(center, xaxs, {1.0f, 0.0f, 0.0f, 1.0f});
-      ctx.DrawLine3D(center, yaxs, {0.0f, 1.0f, 0.0f, 1.0f});
-      ctx.DrawLine3D(center, zaxs, {0.0f, 0.0f, 1.0f, 1.0f});
+      const Line3D axes[] = {{center, xaxs, {1.0f, 0.0f, 0.0f, 1.0f}},
+                             {center, yaxs, {0.0f, 1.0f, 0.0f, 1.0f}},
+                             {center, zaxs, {0.0f, 0.0f, 1.0f, 1.0f}}};
+      ctx.DrawLines3D(axes);
     }
 
     if (!sprite_)
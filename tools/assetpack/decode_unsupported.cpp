@@ -0,0 +1,8 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+// ImageIOの無い環境用(assetpackのビルド確認のみ)
+//
+#include "image_decode.h"
+
+bool DecodeImageFile(const char *, uint32_t, ImageDownsample::Image &) { return false; }
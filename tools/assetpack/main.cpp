@@ -0,0 +1,134 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+// assetpack <output> <resource root> <files...>
+//  画像をデコード済みのRGBA8(ミップマップ付き)に変換して1つのアーカイブにまとめる
+//
+#include "asset_archive.h"
+#include "image_decode.h"
+#include "image_downsample.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+using namespace AssetArchive;
+
+struct PackImage
+{
+  std::string                         name_;
+  ImageDownsample::Image              base_; // 行はRowAlignment境界
+  std::vector<ImageDownsample::Image> mips_;
+  uint64_t                            size_   = 0;
+  uint64_t                            offset_ = 0;
+};
+
+//
+uint64_t AlignUp(uint64_t value, uint64_t align) { return (value + align - 1) & ~(align - 1); }
+
+} // namespace
+
+//
+int main(int argc, char **argv)
+{
+  if (argc < 3)
+  {
+    fprintf(stderr, "usage: assetpack <output> <resource root> <files...>\n");
+    return 1;
+  }
+
+  std::string            root = argv[2];
+  std::vector<PackImage> images;
+  for (int i = 3; i < argc; i++)
+  {
+    PackImage image;
+    image.name_ = argv[i];
+    auto path   = root + "/" + image.name_;
+    if (!DecodeImageFile(path.c_str(), RowAlignment, image.base_))
+    {
+      fprintf(stderr, "assetpack: failed to decode %s\n", argv[i]);
+      return 1;
+    }
+    const auto &base = image.base_;
+    image.mips_      = ImageDownsample::BuildMipChain(
+        base.pixels.data(), base.width, base.height, base.bytesPerRow, true, RowAlignment);
+    image.size_ = base.pixels.size();
+    for (auto &mip : image.mips_)
+    {
+      image.size_ += mip.pixels.size();
+    }
+    images.push_back(std::move(image));
+  }
+
+  uint32_t tableSize = 1;
+  while (tableSize < images.size() * 2)
+  {
+    tableSize <<= 1;
+  }
+
+  std::string strings;
+  for (auto &image : images)
+  {
+    strings += image.name_;
+  }
+
+  ArchiveHeader header{};
+  header.magic        = Magic;
+  header.version      = Version;
+  header.entryCount   = images.size();
+  header.tableSize    = tableSize;
+  header.tableOffset  = sizeof(ArchiveHeader);
+  header.stringOffset = header.tableOffset + sizeof(ArchiveEntry) * tableSize;
+
+  std::vector<ArchiveEntry> table(tableSize, ArchiveEntry{});
+  uint32_t                  nameOffset = 0;
+  uint64_t dataOffset = AlignUp(header.stringOffset + strings.size(), DataAlignment);
+  for (auto &image : images)
+  {
+    ArchiveEntry entry{};
+    entry.hash       = HashName(image.name_);
+    entry.nameOffset = nameOffset;
+    entry.nameLength = image.name_.size();
+    entry.width      = image.base_.width;
+    entry.height     = image.base_.height;
+    entry.format     = (uint32_t)PixelFormat::RGBA8Unorm_sRGB;
+    entry.mipLevels  = image.mips_.size() + 1;
+    entry.dataOffset = dataOffset;
+    entry.dataSize   = image.size_;
+    image.offset_    = dataOffset;
+
+    nameOffset += entry.nameLength;
+    dataOffset = AlignUp(dataOffset + entry.dataSize, DataAlignment);
+
+    auto slot = entry.hash & (tableSize - 1);
+    while (table[slot].hash != 0)
+    {
+      slot = (slot + 1) & (tableSize - 1);
+    }
+    table[slot] = entry;
+  }
+
+  auto *fp = fopen(argv[1], "wb");
+  if (fp == nullptr)
+  {
+    fprintf(stderr, "assetpack: cannot open %s\n", argv[1]);
+    return 1;
+  }
+  fwrite(&header, sizeof(header), 1, fp);
+  fwrite(table.data(), sizeof(ArchiveEntry), table.size(), fp);
+  fwrite(strings.data(), 1, strings.size(), fp);
+  for (auto &image : images)
+  {
+    fseek(fp, image.offset_, SEEK_SET);
+    fwrite(image.base_.pixels.data(), 1, image.base_.pixels.size(), fp);
+    for (auto &mip : image.mips_)
+    {
+      fwrite(mip.pixels.data(), 1, mip.pixels.size(), fp);
+    }
+  }
+  fclose(fp);
+
+  printf("assetpack: %zu images -> %s\n", images.size(), argv[1]);
+  return 0;
+}
@@ -0,0 +1,71 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+//
+// functions/の計測とテスト(Linuxでもビルドできるもの)
+//
+namespace Bench
+{
+
+using Func = void (*)();
+
+struct Case
+{
+  const char *name;
+  Func        func;
+  bool        test;
+};
+
+std::vector<Case> &Registry();
+
+struct Register
+{
+  Register(const char *name, Func func, bool test) { Registry().push_back({name, func, test}); }
+};
+
+void Check(bool ok, const char *expr, const char *file, int line);
+
+// 最速の1回の時間(ms)
+template <class F>
+double MeasureMs(F &&func, int iterations = 10)
+{
+  double best = 1e30;
+  for (int i = 0; i < iterations; i++)
+  {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    std::chrono::duration<double, std::milli> t = std::chrono::steady_clock::now() - start;
+    if (t.count() < best)
+    {
+      best = t.count();
+    }
+  }
+  return best;
+}
+
+// 最適化で消されないようにする
+template <class T>
+inline void Keep(const T &value)
+{
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+} // namespace Bench
+
+#define BENCH_CASE(name)                                                                           \
+  static void           name();                                                                    \
+  static Bench::Register name##Register_{#name, name, false};                                      \
+  static void           name()
+
+#define TEST_CASE(name)                                                                            \
+  static void           name();                                                                    \
+  static Bench::Register name##Register_{#name, name, true};                                       \
+  static void           name()
+
+#define CHECK(expr) Bench::Check(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
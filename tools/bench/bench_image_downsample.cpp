@@ -0,0 +1,109 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "image_downsample.h"
+#include <array>
+#include <random>
+
+namespace
+{
+
+constexpr uint32_t Width  = 4096;
+constexpr uint32_t Height = 4096;
+
+std::vector<uint8_t> MakeImage()
+{
+  std::vector<uint8_t> pixels(Width * Height * 4);
+  std::mt19937         rng{1234};
+  for (auto &p : pixels)
+  {
+    p = static_cast<uint8_t>(rng());
+  }
+  return pixels;
+}
+
+void HalveCase(bool srgb)
+{
+  auto                 src = MakeImage();
+  std::vector<uint8_t> dst((Width / 2) * (Height / 2) * 4);
+  double               ms = Bench::MeasureMs(
+      [&]
+      {
+        ImageDownsample::HalveRGBA8(src.data(), Width, Height, Width * 4, dst.data(), Width * 2,
+                                    srgb);
+        Bench::Keep(dst);
+      });
+  std::printf("  halve %ux%u: %.2f ms (%.0f Mpixel/s)\n", Width, Height, ms,
+              Width * Height / (ms * 1000.0));
+
+  ms = Bench::MeasureMs(
+      [&] { Bench::Keep(ImageDownsample::BuildMipChain(src.data(), Width, Height, Width * 4, srgb)); },
+      5);
+  std::printf("  mip chain:         %.2f ms\n", ms);
+}
+
+// 2x2を縮小した1ピクセル
+std::array<uint8_t, 4> Halve2x2(const std::array<uint8_t, 16> &src, bool srgb)
+{
+  std::array<uint8_t, 4> dst{};
+  ImageDownsample::HalveRGBA8(src.data(), 2, 2, 8, dst.data(), 4, srgb);
+  return dst;
+}
+
+} // namespace
+
+BENCH_CASE(DownsampleLinear) { HalveCase(false); }
+
+BENCH_CASE(DownsampleSRGB) { HalveCase(true); }
+
+// 透明な部分(RGB=0)の色が混ざって暗くならないこと
+TEST_CASE(DownsampleAlphaWeighted)
+{
+  std::array<uint8_t, 16> src{200, 100, 50, 255, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  for (bool srgb : {false, true})
+  {
+    auto dst = Halve2x2(src, srgb);
+    CHECK(dst[0] == 200 && dst[1] == 100 && dst[2] == 50);
+    CHECK(dst[3] == 64);
+  }
+
+  // 半透明同士は重みに比例する
+  src      = {255, 0, 0, 192, 0, 0, 255, 64, 255, 0, 0, 192, 0, 0, 255, 64};
+  auto dst = Halve2x2(src, false);
+  CHECK(dst[0] == 191 && dst[1] == 0 && dst[2] == 64 && dst[3] == 128);
+
+  // 全部透明なら単純な平均
+  src = {40, 80, 120, 0, 40, 80, 120, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  dst = Halve2x2(src, false);
+  CHECK(dst[0] == 20 && dst[1] == 40 && dst[2] == 60 && dst[3] == 0);
+}
+
+// 不透明な画像は単純な平均のまま
+TEST_CASE(DownsampleOpaque)
+{
+  constexpr uint32_t   W = 64, H = 32;
+  std::vector<uint8_t> src(W * H * 4);
+  std::mt19937         rng{42};
+  for (size_t i = 0; i < src.size(); i++)
+  {
+    src[i] = (i & 3) == 3 ? 255 : static_cast<uint8_t>(rng());
+  }
+  std::vector<uint8_t> dst(W / 2 * H / 2 * 4);
+  ImageDownsample::HalveRGBA8(src.data(), W, H, W * 4, dst.data(), W * 2, false);
+  bool same = true;
+  for (uint32_t y = 0; y < H / 2; y++)
+  {
+    for (uint32_t x = 0; x < W / 2; x++)
+    {
+      for (uint32_t c = 0; c < 4; c++)
+      {
+        auto at  = [&](uint32_t sx, uint32_t sy) { return int(src[(sy * W + sx) * 4 + c]); };
+        int  sum = at(x * 2, y * 2) + at(x * 2 + 1, y * 2) + at(x * 2, y * 2 + 1) +
+                  at(x * 2 + 1, y * 2 + 1);
+        same = same && dst[(y * W / 2 + x) * 4 + c] == (sum + 2) / 4;
+      }
+    }
+  }
+  CHECK(same);
+}
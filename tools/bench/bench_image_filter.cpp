@@ -0,0 +1,87 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "image_filter.h"
+#include <random>
+
+namespace
+{
+
+constexpr uint32_t Width  = 1024;
+constexpr uint32_t Height = 1024;
+
+ImageFilter::ImageF MakeImage()
+{
+  ImageFilter::ImageF image;
+  image.resize(Width, Height);
+  std::mt19937                          rng{1234};
+  std::uniform_real_distribution<float> dist{0.0f, 1.0f};
+  for (auto &p : image.pixels)
+  {
+    p = dist(rng);
+  }
+  return image;
+}
+
+void Report(const char *name, const ImageFilter::Node &node, const ImageFilter::ImageF &src)
+{
+  ImageFilter::ImageF dst;
+  double              ms = Bench::MeasureMs(
+      [&]
+      {
+        node.apply(src, dst);
+        Bench::Keep(dst);
+      });
+  std::printf("  %-16s %7.2f ms (%.0f Mpixel/s)\n", name, ms, Width * Height / (ms * 1000.0));
+}
+
+} // namespace
+
+// ノード毎の処理時間(1024x1024)
+BENCH_CASE(FilterNodes)
+{
+  auto src = MakeImage();
+  Report("ColorMatrix", ImageFilter::ColorMatrix{}, src);
+  Report("BoxBlur r=4", ImageFilter::BoxBlur{4}, src);
+  Report("BoxBlur r=16", ImageFilter::BoxBlur{16}, src);
+  Report("Gaussian s=2", ImageFilter::GaussianBlur{2.0f}, src);
+  Report("Gaussian s=8", ImageFilter::GaussianBlur{8.0f}, src);
+  Report("Threshold", ImageFilter::Threshold{0.5f}, src);
+  Report("Tint", ImageFilter::Tint{1.0f, 0.8f, 0.6f, 0.5f}, src);
+}
+
+// 最後の段だけ変えた時と先頭を変えた時のグラフ全体
+BENCH_CASE(FilterGraph)
+{
+  std::vector<uint8_t> rgba(Width * Height * 4);
+  std::mt19937         rng{1234};
+  for (auto &p : rgba)
+  {
+    p = static_cast<uint8_t>(rng());
+  }
+  ImageFilter::Graph graph;
+  graph.setSource(rgba.data(), Width, Height, Width * 4);
+  auto blur = graph.add<ImageFilter::GaussianBlur>(2.0f);
+  graph.add<ImageFilter::ColorMatrix>();
+  auto tint = graph.add<ImageFilter::Tint>();
+  graph.process();
+
+  float  amount = 0.0f;
+  double ms     = Bench::MeasureMs(
+      [&]
+      {
+        tint->setColor(1.0f, 0.5f, 0.5f, amount += 0.01f);
+        graph.process();
+      });
+  std::printf("  last stage:      %7.2f ms\n", ms);
+
+  float sigma = 2.0f;
+  ms          = Bench::MeasureMs(
+      [&]
+      {
+        blur->setSigma(sigma += 0.01f);
+        graph.process();
+      });
+  std::printf("  all stages:      %7.2f ms\n", ms);
+}
@@ -0,0 +1,109 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "job_system.h"
+#include <cmath>
+
+namespace
+{
+
+constexpr size_t Elements = 1 << 20;
+constexpr size_t Tasks    = 10000;
+
+// 1要素分の計算(メモリより演算で律速するように)
+inline float Work(size_t i)
+{
+  float x = float(i & 1023) * 0.001f;
+  for (int k = 0; k < 4; k++)
+  {
+    x = std::sqrt(x * x + 1.0f) * 0.5f;
+  }
+  return x;
+}
+
+// 1..Nスレッド(1は単純なループ、2以上はワーカー数N-1のJobSystem)
+// amountは1msあたりに換算するとunitになる量
+template <class Serial, class Parallel>
+void Scaling(const char *unit, double amount, Serial &&serial, Parallel &&parallel)
+{
+  auto   maxThreads = std::max(std::thread::hardware_concurrency(), 2u);
+  double base       = Bench::MeasureMs(serial, 5);
+  std::printf("  threads  1: %7.2f ms %8.1f %s\n", base, amount / base, unit);
+  for (unsigned threads = 2; threads <= maxThreads; threads++)
+  {
+    JobSystem system{threads - 1};
+    double    ms = Bench::MeasureMs([&] { parallel(system); }, 5);
+    std::printf("  threads %2u: %7.2f ms %8.1f %s (x%.2f)\n",
+                threads,
+                ms,
+                amount / ms,
+                unit,
+                base / ms);
+  }
+}
+
+} // namespace
+
+BENCH_CASE(JobParallelFor)
+{
+  std::vector<float> out(Elements);
+  Scaling(
+      "Melem/s",
+      Elements / 1000.0,
+      [&]
+      {
+        for (size_t i = 0; i < Elements; i++)
+        {
+          out[i] = Work(i);
+        }
+        Bench::Keep(out);
+      },
+      [&](JobSystem &system)
+      {
+        system.parallelFor(Elements,
+                           1024,
+                           [&](size_t begin, size_t end)
+                           {
+                             for (size_t i = begin; i < end; i++)
+                             {
+                               out[i] = Work(i);
+                             }
+                           });
+        Bench::Keep(out);
+      });
+}
+
+// 小さなジョブをたくさん投入する(1ジョブ64要素)
+BENCH_CASE(JobTaskGroup)
+{
+  std::vector<float> out(Tasks * 64);
+  auto               task = [&](size_t index)
+  {
+    for (size_t i = index * 64; i < (index + 1) * 64; i++)
+    {
+      out[i] = Work(i);
+    }
+  };
+  Scaling(
+      "Ktask/s",
+      Tasks,
+      [&]
+      {
+        for (size_t t = 0; t < Tasks; t++)
+        {
+          task(t);
+        }
+        Bench::Keep(out);
+      },
+      [&](JobSystem &system)
+      {
+        JobSystem::TaskGroup group{system};
+        for (size_t t = 0; t < Tasks; t++)
+        {
+          group.run([&task, t] { task(t); });
+        }
+        group.wait();
+        Bench::Keep(out);
+      });
+}
@@ -0,0 +1,228 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "command_list2d.h"
+#include "prim2d_geometry.h"
+#include "prim3d_batch.h"
+#include <cstring>
+#include <mutex>
+#include <random>
+
+namespace
+{
+
+// shader_def.hはFoundationに依存するので同じ並びの頂点を使う
+struct Vertex2D
+{
+  simd_float2 position;
+  float16x4_t color;
+};
+struct Vertex3D
+{
+  simd_float3 position;
+  float16x4_t color;
+};
+
+// Draw2D/Draw3Dのreserveと同じく、ロックして頂点数を進める(SimpleLockの代わりにstd::mutex)
+template <class Vertex>
+class Reserver
+{
+  std::mutex          lock_;
+  std::vector<Vertex> opaque_;
+  std::vector<Vertex> translucent_;
+  size_t              nbOpaque_      = 0;
+  size_t              nbTranslucent_ = 0;
+
+public:
+  explicit Reserver(size_t capacity) : opaque_(capacity), translucent_(capacity) {}
+
+  Vertex *reserve(size_t nbVertices, bool translucent = false)
+  {
+    std::lock_guard guard{lock_};
+    if (nbOpaque_ + nbTranslucent_ + nbVertices > opaque_.size())
+    {
+      return nullptr;
+    }
+    auto &count = translucent ? nbTranslucent_ : nbOpaque_;
+    auto *vtx   = (translucent ? translucent_.data() : opaque_.data()) + count;
+    count += nbVertices;
+    return vtx;
+  }
+  void reset() { nbOpaque_ = nbTranslucent_ = 0; }
+};
+
+// Draw2Dのreserve:pipeline:texture:bounds:とunreserve:pipeline:end:から
+// Metalのバッファとメッセージ送信を除いたもの(SimpleLockの代わりにstd::mutex)
+class Draw2DPath
+{
+  using Commands = CommandList2D<const void *, const void *>;
+
+  std::mutex            lock_;
+  Commands              cmdList_;
+  Commands::TextureIds  textureIds_;
+  std::vector<Vertex2D> vertices_;
+  size_t                count_ = 0;
+  uint32_t              layer_ = 0x8000;
+
+public:
+  explicit Draw2DPath(size_t capacity) : vertices_(capacity) { reset(); }
+
+  Vertex2D *reserve(size_t nbVertices, Pipeline2D pipeline)
+  {
+    std::lock_guard guard{lock_};
+    auto            start = cmdList_.reserve(nbVertices,
+                                  pipeline,
+                                  layer_,
+                                  NoClip,
+                                  vertices_.data(),
+                                  nullptr,
+                                  count_,
+                                  vertices_.size(),
+                                  nullptr);
+    return start == Commands::NoSpace ? nullptr : vertices_.data() + start;
+  }
+  void unreserve(size_t unused, Vertex2D *end)
+  {
+    std::lock_guard guard{lock_};
+    if (!cmdList_.shrink(vertices_.data(), count_, end - vertices_.data(), unused))
+    {
+      std::memset((void *)end, 0, unused * sizeof(Vertex2D));
+    }
+  }
+  void reset()
+  {
+    count_ = 0;
+    textureIds_.clear();
+    cmdList_.reset(&textureIds_);
+  }
+  size_t vertexCount() const { return count_; }
+  size_t commandCount() const { return cmdList_.commands().size(); }
+};
+
+constexpr size_t Count = 100000;
+
+float Random(std::mt19937 &rng, float range)
+{
+  return std::uniform_real_distribution<float>{-range, range}(rng);
+}
+
+} // namespace
+
+// drawTriangle:を繰り返す場合とdrawTriangles:count:colors:でまとめる場合
+BENCH_CASE(PrimBatch3D)
+{
+  std::mt19937            rng{1234};
+  std::vector<Triangle3D> triangles(Count);
+  std::vector<simd_float4> colors(Count);
+  for (size_t i = 0; i < Count; i++)
+  {
+    auto center  = simd_make_float3(Random(rng, 100), Random(rng, 100), Random(rng, 100));
+    triangles[i] = {center + simd_make_float3(1, 0, 0),
+                    center + simd_make_float3(0, 1, 0),
+                    center + simd_make_float3(0, 0, 1)};
+    colors[i]    = simd_make_float4(1.0f, 0.5f, 0.25f, i % 4 == 0 ? 0.5f : 1.0f);
+  }
+
+  Reserver<Vertex3D> reserver{Count * 3};
+  auto               reserve = [&](size_t nbVertices, bool translucent)
+  { return reserver.reserve(nbVertices, translucent); };
+
+  double perCall = Bench::MeasureMs(
+      [&]
+      {
+        reserver.reset();
+        for (size_t i = 0; i < Count; i++)
+        {
+          const auto &tri = triangles[i];
+          if (auto *vtx3d = reserver.reserve(3, colors[i].w < 1.0f))
+          {
+            Prim3D::WriteTriangle(vtx3d, tri.p0, tri.p1, tri.p2, vcvt_f16_f32(colors[i]));
+          }
+        }
+      });
+  double batch = Bench::MeasureMs(
+      [&]
+      {
+        reserver.reset();
+        Prim3D::WriteTriangles(triangles.data(), Count, colors.data(), Count, reserve);
+      });
+  double single = Bench::MeasureMs(
+      [&]
+      {
+        reserver.reset();
+        Prim3D::WriteTriangles(triangles.data(), Count, colors.data(), 1, reserve);
+      });
+  std::printf("  %zu triangles\n", Count);
+  std::printf("  per call:          %6.2f ms\n", perCall);
+  std::printf("  batch (per color): %6.2f ms (x%.1f)\n", batch, perCall / batch);
+  std::printf("  batch (one color): %6.2f ms (x%.1f)\n", single, perCall / single);
+}
+
+// fillRect:を繰り返す場合とfillRects:count:でまとめる場合(画面外のものは捨てる)
+// どちらもDraw2Dと同じコマンドの記録(ソートキーと結合)を通す
+BENCH_CASE(PrimBatch2D)
+{
+  std::mt19937        rng{1234};
+  std::vector<Rect2D> rects(Count);
+  for (auto &rect : rects)
+  {
+    auto pos = simd_make_float2(Random(rng, 1200), Random(rng, 1200));
+    rect     = {pos, pos + simd_make_float2(8, 8), simd_make_float4(1, 1, 1, 1)};
+  }
+
+  float      scale = 2.0f;
+  ClipRect2D clip{simd_make_float2(0, 0), simd_make_float2(1920, 1080)};
+  auto       shown = [&](const Rect2D &rect)
+  {
+    auto from = rect.from * scale;
+    auto to   = rect.to * scale;
+    return Overlaps(clip, simd_min(from, to), simd_max(from, to));
+  };
+  auto write = [&](Vertex2D *vtx2d, const Rect2D &rect)
+  { Prim2D::WriteRectFill(vtx2d, rect.from * scale, rect.to * scale, vcvt_f16_f32(rect.color)); };
+
+  Draw2DPath draw2d{Count * Prim2D::RectFillVertices};
+  double     perCall = Bench::MeasureMs(
+      [&]
+      {
+        draw2d.reset();
+        for (const auto &rect : rects)
+        {
+          if (!shown(rect))
+          {
+            continue;
+          }
+          if (auto *vtx2d = draw2d.reserve(Prim2D::RectFillVertices, PipelineFill))
+          {
+            write(vtx2d, rect);
+          }
+        }
+      });
+  auto perCallVertices = draw2d.vertexCount();
+  auto perCallCommands = draw2d.commandCount();
+
+  double batch = Bench::MeasureMs(
+      [&]
+      {
+        draw2d.reset();
+        Prim2D::WriteVisible(
+            rects.data(),
+            Count,
+            Prim2D::RectFillVertices,
+            shown,
+            [&](size_t nbVertices) { return draw2d.reserve(nbVertices, PipelineFill); },
+            write,
+            [&](Vertex2D *end, size_t unused) { draw2d.unreserve(unused, end); });
+      });
+  std::printf("  %zu rects, %zu vertices\n", Count, draw2d.vertexCount());
+  std::printf("  per call: %6.2f ms (%zu commands)\n", perCall, perCallCommands);
+  std::printf("  batch:    %6.2f ms (x%.1f, %zu commands)\n",
+              batch,
+              perCall / batch,
+              draw2d.commandCount());
+  if (perCallVertices != draw2d.vertexCount())
+  {
+    std::printf("  vertex count mismatch: %zu\n", perCallVertices);
+  }
+}
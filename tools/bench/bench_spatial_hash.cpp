@@ -0,0 +1,115 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "spatial_hash.h"
+#include <array>
+#include <chrono>
+#include <random>
+
+namespace
+{
+
+constexpr uint32_t Sprites = 100000;
+constexpr float    World   = 20000.0f;
+
+using Quad = std::array<simd_float2, 4>;
+
+// 8..48ピクセルの四角形(トライアングルストリップ順)。番号は1から
+std::vector<Quad> MakeQuads(std::mt19937 &rng)
+{
+  std::uniform_real_distribution<float> pos{0.0f, World};
+  std::uniform_real_distribution<float> size{8.0f, 48.0f};
+  std::vector<Quad>                     quads(Sprites + 1);
+  for (uint32_t i = 1; i <= Sprites; i++)
+  {
+    float x = pos(rng), y = pos(rng), w = size(rng), h = size(rng);
+    quads[i] = {simd_make_float2(x + w, y),
+                simd_make_float2(x, y),
+                simd_make_float2(x + w, y + h),
+                simd_make_float2(x, y + h)};
+  }
+  return quads;
+}
+
+// Draw2DのupdateSpriteIndexと同じ1フレーム分の更新
+void UpdateAll(SpatialHash2D &index, const std::vector<Quad> &quads)
+{
+  index.beginFrame();
+  for (uint32_t i = 1; i <= Sprites; i++)
+  {
+    index.update(i, quads[i].data(), i);
+  }
+  index.sweep();
+}
+
+template <class Func>
+double TimeMs(Func &&func)
+{
+  auto start = std::chrono::steady_clock::now();
+  func();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace
+
+// 10万スプライトの索引の更新と問い合わせ
+BENCH_CASE(SpatialHash)
+{
+  std::mt19937  rng{3};
+  auto          quads = MakeQuads(rng);
+  SpatialHash2D index{64.0f, 1 << 16};
+
+  std::printf("  %u sprites\n", Sprites);
+  std::printf("  build:              %7.2f ms\n", TimeMs([&] { UpdateAll(index, quads); }));
+  std::printf("  update (unchanged): %7.2f ms\n",
+              Bench::MeasureMs([&] { UpdateAll(index, quads); }, 5));
+  double moved = Bench::MeasureMs(
+      [&]
+      {
+        for (auto &quad : quads)
+        {
+          for (auto &corner : quad)
+          {
+            corner.x += 1.5f;
+          }
+        }
+        UpdateAll(index, quads);
+      },
+      5);
+  std::printf("  update (all moved): %7.2f ms\n", moved);
+
+  std::uniform_real_distribution<float> pos{0.0f, World};
+  std::vector<SpatialHash2D::Handle>    out;
+  size_t                                hits = 0;
+  double                                ms   = TimeMs(
+      [&]
+      {
+        for (int i = 0; i < 100000; i++)
+        {
+          out.clear();
+          index.queryPoint(simd_make_float2(pos(rng), pos(rng)), out);
+          hits += out.size();
+        }
+      });
+  std::printf("  100k point queries: %7.2f ms (%zu hits)\n", ms, hits);
+
+  hits = 0;
+  ms   = TimeMs(
+      [&]
+      {
+        for (int i = 0; i < 10000; i++)
+        {
+          auto from = simd_make_float2(pos(rng), pos(rng));
+          out.clear();
+          index.queryRect(from, from + simd_make_float2(256.0f, 256.0f), out);
+          hits += out.size();
+        }
+      });
+  std::printf("  10k rect queries:   %7.2f ms (%zu hits)\n", ms, hits);
+
+  std::vector<std::pair<SpatialHash2D::Handle, SpatialHash2D::Handle>> pairs;
+  ms = TimeMs([&] { index.queryPairs(pairs); });
+  std::printf("  all pairs:          %7.2f ms (%zu pairs)\n", ms, pairs.size());
+}
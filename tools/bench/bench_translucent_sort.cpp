@@ -0,0 +1,107 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "translucent_sort.h"
+#include <chrono>
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+// VertexDataPrim3Dと同じ大きさ(色は使わない)
+struct Vertex3D
+{
+  simd_float3 position;
+  uint16_t    color[4];
+};
+
+constexpr size_t Triangles = 100000;
+
+std::vector<Vertex3D> MakeTriangles(size_t count)
+{
+  std::mt19937                          rng{1234};
+  std::uniform_real_distribution<float> dist{-100.0f, 100.0f};
+  std::vector<Vertex3D>                 vertices(count * 3);
+  for (size_t i = 0; i < count; i++)
+  {
+    auto center = simd_make_float3(dist(rng), dist(rng), dist(rng));
+    for (int v = 0; v < 3; v++)
+    {
+      vertices[i * 3 + v].position = center + simd_make_float3(v == 0, v == 1, v == 2);
+    }
+  }
+  return vertices;
+}
+
+// y軸回りに回るカメラのzの行
+simd_float4 ViewRow(float angle)
+{
+  return simd_make_float4(std::sin(angle), 0.0f, -std::cos(angle), -200.0f);
+}
+
+double Elapsed(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace
+
+// 10万個の三角形を毎フレーム並べ替える(カメラが回るので順番は毎回変わる)
+BENCH_CASE(TranslucentSort)
+{
+  auto                  src = MakeTriangles(Triangles);
+  std::vector<Vertex3D> dst(src.size());
+  Translucent::Sorter   sorter;
+  sorter.sort(src.data(), Triangles, ViewRow(0.0f), dst.data());
+
+  constexpr int Frames  = 20;
+  double        keys    = 0.0;
+  double        sort    = 0.0;
+  double        scatter = 0.0;
+  double        best    = 1e30;
+  for (int frame = 1; frame <= Frames; frame++)
+  {
+    auto start = std::chrono::steady_clock::now();
+    sorter.buildKeys(src.data(), Triangles, ViewRow(frame * 0.05f));
+    auto t0 = Elapsed(start);
+    sorter.sortKeys();
+    auto t1 = Elapsed(start);
+    sorter.scatter(src.data(), dst.data());
+    auto t2 = Elapsed(start);
+    Bench::Keep(dst);
+
+    keys += t0;
+    sort += t1 - t0;
+    scatter += t2 - t1;
+    best = std::min(best, t2);
+  }
+  std::printf("  %zu triangles, average of %d frames\n", Triangles, Frames);
+  std::printf("  keys:    %6.2f ms\n", keys / Frames);
+  std::printf("  sort:    %6.2f ms\n", sort / Frames);
+  std::printf("  scatter: %6.2f ms\n", scatter / Frames);
+  std::printf("  frame:   %6.2f ms (best %.2f ms)\n", (keys + sort + scatter) / Frames, best);
+}
+
+// 奥(zが小さい)から順に並ぶ
+TEST_CASE(TranslucentSortOrder)
+{
+  auto                  src = MakeTriangles(20000);
+  std::vector<Vertex3D> dst(src.size());
+  Translucent::Sorter   sorter;
+  auto                  row = ViewRow(0.7f);
+  sorter.sort(src.data(), 20000, row, dst.data());
+
+  bool  ordered = true;
+  float last    = -INFINITY;
+  for (size_t i = 0; i < 20000; i++)
+  {
+    auto  center = dst[i * 3].position + dst[i * 3 + 1].position + dst[i * 3 + 2].position;
+    float z      = simd_dot(row.xyz, center) + row.w * 3.0f;
+    ordered      = ordered && z >= last;
+    last         = z;
+  }
+  CHECK(ordered);
+}
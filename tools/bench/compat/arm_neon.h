@@ -0,0 +1,26 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <simd/simd.h>
+
+//
+// Apple以外で計測をビルドするための<arm_neon.h>の代わり
+// 頂点カラーの変換(vcvt_f16_f32)だけを用意する
+//
+#if defined(__ARM_NEON)
+#include_next <arm_neon.h>
+
+inline float16x4_t vcvt_f16_f32(simd_float4 v)
+{
+  return vcvt_f16_f32(float32x4_t{v.x, v.y, v.z, v.w});
+}
+#else
+typedef _Float16 float16x4_t __attribute__((vector_size(8)));
+
+inline float16x4_t vcvt_f16_f32(simd_float4 v)
+{
+  return float16x4_t{(_Float16)v.x, (_Float16)v.y, (_Float16)v.z, (_Float16)v.w};
+}
+#endif
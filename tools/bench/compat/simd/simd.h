@@ -0,0 +1,226 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cmath>
+
+//
+// Apple以外で計測をビルドするための<simd/simd.h>の代わり
+// functions/で使っている範囲だけ(スウィズルは.xyzのみ)
+//
+
+struct simd_float2
+{
+  float x, y;
+
+  float &operator[](int i) { return (&x)[i]; }
+  float  operator[](int i) const { return (&x)[i]; }
+};
+
+struct alignas(16) simd_float3
+{
+  float x, y, z, pad_;
+
+  float &operator[](int i) { return (&x)[i]; }
+  float  operator[](int i) const { return (&x)[i]; }
+};
+
+union alignas(16) simd_float4
+{
+  struct
+  {
+    float x, y, z, w;
+  };
+  simd_float3 xyz;
+
+  simd_float4() = default;
+  // スカラーは全要素に広げる
+  simd_float4(float s) { x = y = z = w = s; }
+
+  float &operator[](int i) { return (&x)[i]; }
+  float  operator[](int i) const { return (&x)[i]; }
+};
+
+// 4バイト境界でよいもの
+typedef simd_float4 simd_packed_float4 __attribute__((aligned(4)));
+
+// 比較の結果(真なら-1)
+struct simd_int4
+{
+  int v[4];
+
+  int operator[](int i) const { return v[i]; }
+};
+
+#define SIMD_COMPAT_OPERATORS(T, APPLY)                                                            \
+  inline T operator+(T a, T b) { return APPLY(a, b, +); }                                          \
+  inline T operator-(T a, T b) { return APPLY(a, b, -); }                                          \
+  inline T operator*(T a, T b) { return APPLY(a, b, *); }                                          \
+  inline T operator/(T a, T b) { return APPLY(a, b, /); }                                          \
+  inline T operator*(T a, float s) { return a * Splat(T{}, s); }                                   \
+  inline T operator*(float s, T a) { return a * Splat(T{}, s); }                                   \
+  inline T operator/(T a, float s) { return a / Splat(T{}, s); }                                   \
+  inline T operator/(float s, T a) { return Splat(T{}, s) / a; }                                   \
+  inline T operator+(T a, float s) { return a + Splat(T{}, s); }                                   \
+  inline T operator-(T a, float s) { return a - Splat(T{}, s); }                                   \
+  inline T operator-(T a) { return Splat(T{}, 0.0f) - a; }                                         \
+  inline T &operator+=(T &a, T b) { return a = a + b; }                                            \
+  inline T &operator-=(T &a, T b) { return a = a - b; }                                            \
+  inline T &operator*=(T &a, T b) { return a = a * b; }                                            \
+  inline T &operator*=(T &a, float s) { return a = a * s; }
+
+inline simd_float2 Splat(simd_float2, float s) { return {s, s}; }
+inline simd_float3 Splat(simd_float3, float s) { return {s, s, s, 0.0f}; }
+inline simd_float4 Splat(simd_float4, float s)
+{
+  simd_float4 r;
+  r.x = r.y = r.z = r.w = s;
+  return r;
+}
+
+#define SIMD_COMPAT_APPLY2(a, b, op) simd_float2{a.x op b.x, a.y op b.y}
+#define SIMD_COMPAT_APPLY3(a, b, op) simd_float3{a.x op b.x, a.y op b.y, a.z op b.z, 0.0f}
+#define SIMD_COMPAT_APPLY4(a, b, op) simd_make_float4(a.x op b.x, a.y op b.y, a.z op b.z, a.w op b.w)
+
+inline simd_float2 simd_make_float2(float x, float y) { return {x, y}; }
+inline simd_float3 simd_make_float3(float x, float y, float z) { return {x, y, z, 0.0f}; }
+inline simd_float3 simd_make_float3(simd_float2 xy, float z) { return {xy.x, xy.y, z, 0.0f}; }
+inline simd_float4 simd_make_float4(float x, float y, float z, float w)
+{
+  simd_float4 r;
+  r.x = x;
+  r.y = y;
+  r.z = z;
+  r.w = w;
+  return r;
+}
+inline simd_float4 simd_make_float4(simd_float3 xyz, float w)
+{
+  return simd_make_float4(xyz.x, xyz.y, xyz.z, w);
+}
+
+SIMD_COMPAT_OPERATORS(simd_float2, SIMD_COMPAT_APPLY2)
+SIMD_COMPAT_OPERATORS(simd_float3, SIMD_COMPAT_APPLY3)
+SIMD_COMPAT_OPERATORS(simd_float4, SIMD_COMPAT_APPLY4)
+
+#undef SIMD_COMPAT_OPERATORS
+#undef SIMD_COMPAT_APPLY2
+#undef SIMD_COMPAT_APPLY3
+#undef SIMD_COMPAT_APPLY4
+
+inline float simd_dot(simd_float2 a, simd_float2 b) { return a.x * b.x + a.y * b.y; }
+inline float simd_dot(simd_float3 a, simd_float3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float simd_dot(simd_float4 a, simd_float4 b)
+{
+  return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+inline float Min(float a, float b) { return b < a ? b : a; }
+inline float Max(float a, float b) { return a < b ? b : a; }
+
+inline simd_float2 simd_min(simd_float2 a, simd_float2 b) { return {Min(a.x, b.x), Min(a.y, b.y)}; }
+inline simd_float2 simd_max(simd_float2 a, simd_float2 b) { return {Max(a.x, b.x), Max(a.y, b.y)}; }
+inline simd_float2 simd_floor(simd_float2 a) { return {std::floor(a.x), std::floor(a.y)}; }
+
+inline simd_float3 simd_min(simd_float3 a, simd_float3 b)
+{
+  return {Min(a.x, b.x), Min(a.y, b.y), Min(a.z, b.z), 0.0f};
+}
+inline simd_float3 simd_max(simd_float3 a, simd_float3 b)
+{
+  return {Max(a.x, b.x), Max(a.y, b.y), Max(a.z, b.z), 0.0f};
+}
+
+inline simd_float4 simd_mix(simd_float4 a, simd_float4 b, simd_float4 t) { return a + (b - a) * t; }
+
+inline simd_int4 operator>=(simd_float4 a, simd_float4 b)
+{
+  return {{a.x >= b.x ? -1 : 0, a.y >= b.y ? -1 : 0, a.z >= b.z ? -1 : 0, a.w >= b.w ? -1 : 0}};
+}
+inline bool simd_any(simd_int4 a) { return (a.v[0] | a.v[1] | a.v[2] | a.v[3]) < 0; }
+
+// 行列は列で持つ
+struct simd_float3x3
+{
+  simd_float3 columns[3];
+};
+
+struct simd_float4x4
+{
+  simd_float4 columns[4];
+};
+typedef simd_float4x4 matrix_float4x4;
+
+// (ix, iy, iz, r)
+struct simd_quatf
+{
+  simd_float4 vector;
+};
+
+inline simd_quatf simd_quaternion(float ix, float iy, float iz, float r)
+{
+  return {simd_make_float4(ix, iy, iz, r)};
+}
+// axisは単位ベクトル
+inline simd_quatf simd_quaternion(float angle, simd_float3 axis)
+{
+  auto s = std::sin(angle * 0.5f);
+  return simd_quaternion(axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f));
+}
+
+inline simd_float3x3 simd_matrix3x3(simd_quatf q)
+{
+  float x = q.vector.x;
+  float y = q.vector.y;
+  float z = q.vector.z;
+  float w = q.vector.w;
+  return {{simd_make_float3(1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w)),
+           simd_make_float3(2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w)),
+           simd_make_float3(2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y))}};
+}
+inline simd_float4x4 simd_matrix4x4(simd_quatf q)
+{
+  auto m = simd_matrix3x3(q);
+  return {{simd_make_float4(m.columns[0], 0.0f),
+           simd_make_float4(m.columns[1], 0.0f),
+           simd_make_float4(m.columns[2], 0.0f),
+           simd_make_float4(0.0f, 0.0f, 0.0f, 1.0f)}};
+}
+
+inline simd_float4x4 simd_matrix(simd_float4 c0, simd_float4 c1, simd_float4 c2, simd_float4 c3)
+{
+  return {{c0, c1, c2, c3}};
+}
+inline const simd_float4x4 matrix_identity_float4x4 =
+    simd_matrix(simd_make_float4(1.0f, 0.0f, 0.0f, 0.0f),
+                simd_make_float4(0.0f, 1.0f, 0.0f, 0.0f),
+                simd_make_float4(0.0f, 0.0f, 1.0f, 0.0f),
+                simd_make_float4(0.0f, 0.0f, 0.0f, 1.0f));
+
+inline simd_float4 simd_mul(const simd_float4x4 &m, simd_float4 v)
+{
+  return m.columns[0] * v.x + m.columns[1] * v.y + m.columns[2] * v.z + m.columns[3] * v.w;
+}
+inline simd_float4x4 simd_mul(const simd_float4x4 &a, const simd_float4x4 &b)
+{
+  return simd_matrix(simd_mul(a, b.columns[0]),
+                     simd_mul(a, b.columns[1]),
+                     simd_mul(a, b.columns[2]),
+                     simd_mul(a, b.columns[3]));
+}
+
+inline simd_float4x4 simd_matrix_from_rows(simd_float4 r0, simd_float4 r1, simd_float4 r2,
+                                           simd_float4 r3)
+{
+  return simd_matrix(simd_make_float4(r0.x, r1.x, r2.x, r3.x),
+                     simd_make_float4(r0.y, r1.y, r2.y, r3.y),
+                     simd_make_float4(r0.z, r1.z, r2.z, r3.z),
+                     simd_make_float4(r0.w, r1.w, r2.w, r3.w));
+}
+
+inline simd_float3 simd_cross(simd_float3 a, simd_float3 b)
+{
+  return simd_make_float3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+inline simd_float3 simd_normalize(simd_float3 a) { return a / std::sqrt(simd_dot(a, a)); }
@@ -0,0 +1,73 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include <cstring>
+#include <string_view>
+
+namespace
+{
+int failures = 0;
+} // namespace
+
+namespace Bench
+{
+
+std::vector<Case> &Registry()
+{
+  static std::vector<Case> cases;
+  return cases;
+}
+
+void Check(bool ok, const char *expr, const char *file, int line)
+{
+  if (!ok)
+  {
+    std::printf("  FAILED: %s (%s:%d)\n", expr, file, line);
+    failures++;
+  }
+}
+
+} // namespace Bench
+
+//
+// bench [--test] [filter]
+//  --test: テストを実行する(省略時は計測)
+//  filter: 名前に含まれるものだけ実行する
+//
+int main(int argc, char **argv)
+{
+  bool             test = false;
+  std::string_view filter;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--test") == 0)
+    {
+      test = true;
+    }
+    else
+    {
+      filter = argv[i];
+    }
+  }
+
+  int count = 0;
+  for (auto &c : Bench::Registry())
+  {
+    if (c.test != test || std::string_view{c.name}.find(filter) == std::string_view::npos)
+    {
+      continue;
+    }
+    std::printf("[%s]\n", c.name);
+    std::fflush(stdout);
+    int before = failures;
+    c.func();
+    if (test && failures == before)
+    {
+      std::printf("  ok\n");
+    }
+    count++;
+  }
+  std::printf("%d case(s), %d failure(s)\n", count, failures);
+  return failures == 0 ? 0 : 1;
+}
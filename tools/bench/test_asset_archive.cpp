@@ -0,0 +1,142 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "asset_archive.h"
+#include "bench.h"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+using namespace AssetArchive;
+
+namespace
+{
+
+constexpr std::string_view Name = "image.png";
+
+// 4x4、3レベルのエントリを1つ持つアーカイブ
+struct Archive
+{
+  ArchiveHeader        header{};
+  ArchiveEntry         entry{};
+  std::vector<uint8_t> bytes;
+
+  Archive()
+  {
+    header.magic        = Magic;
+    header.version      = Version;
+    header.entryCount   = 1;
+    header.tableSize    = 2;
+    header.tableOffset  = sizeof(ArchiveHeader);
+    header.stringOffset = header.tableOffset + sizeof(ArchiveEntry) * 2;
+
+    entry.hash       = HashName(Name);
+    entry.nameOffset = 0;
+    entry.nameLength = Name.size();
+    entry.width      = 4;
+    entry.height     = 4;
+    entry.mipLevels  = 3;
+    entry.dataOffset = DataAlignment;
+    entry.dataSize   = RowAlignment * (4 + 2 + 1);
+  }
+
+  std::vector<uint8_t> build() const
+  {
+    std::vector<uint8_t> out(DataAlignment + RowAlignment * 7);
+    std::memcpy(out.data(), &header, sizeof(header));
+    std::memcpy(out.data() + header.tableOffset + (entry.hash & 1) * sizeof(ArchiveEntry), &entry,
+                sizeof(entry));
+    std::memcpy(out.data() + header.stringOffset, Name.data(), Name.size());
+    return out;
+  }
+};
+
+// 一時ファイルに書いて開く
+bool Open(Reader &reader, const std::vector<uint8_t> &bytes)
+{
+  char path[] = "/tmp/archiveXXXXXX";
+  int  fd     = mkstemp(path);
+  if (fd < 0)
+  {
+    return false;
+  }
+  bool written = write(fd, bytes.data(), bytes.size()) == (ssize_t)bytes.size();
+  ::close(fd);
+  bool opened = written && reader.open(path);
+  unlink(path);
+  return opened;
+}
+
+} // namespace
+
+TEST_CASE(ArchiveValid)
+{
+  Archive archive;
+  Reader  reader;
+  CHECK(Open(reader, archive.build()));
+  auto *entry = reader.find(Name);
+  CHECK(entry != nullptr);
+  if (entry != nullptr)
+  {
+    auto level = reader.getLevel(*entry, 2);
+    CHECK(level.data != nullptr && level.width == 1 && level.height == 1);
+    CHECK(reader.getLevel(*entry, 3).data == nullptr);
+  }
+}
+
+TEST_CASE(ArchiveTruncated)
+{
+  Archive archive;
+  Reader  reader;
+
+  // ヘッダより短い
+  auto bytes = archive.build();
+  bytes.resize(sizeof(ArchiveHeader) - 1);
+  CHECK(!Open(reader, bytes));
+
+  // テクスチャデータの途中で切れている
+  bytes = archive.build();
+  bytes.resize(bytes.size() - 1);
+  CHECK(Open(reader, bytes) && reader.find(Name) == nullptr);
+}
+
+TEST_CASE(ArchiveCorrupt)
+{
+  Reader reader;
+  {
+    // テーブルの位置が溢れる
+    Archive archive;
+    archive.header.tableOffset = ~0ull - 8;
+    CHECK(!Open(reader, archive.build()));
+  }
+  {
+    // 文字列の位置が溢れる
+    Archive archive;
+    archive.entry.nameOffset = ~0u - 2;
+    CHECK(Open(reader, archive.build()) && reader.find(Name) == nullptr);
+  }
+  {
+    // dataOffset + dataSizeが溢れる
+    Archive archive;
+    archive.entry.dataSize = ~0ull - DataAlignment + 1;
+    CHECK(Open(reader, archive.build()) && reader.find(Name) == nullptr);
+  }
+  {
+    // ミップレベルの合計がdataSizeを超える
+    Archive archive;
+    archive.entry.dataSize = RowAlignment * 6;
+    CHECK(Open(reader, archive.build()) && reader.find(Name) == nullptr);
+  }
+  {
+    // 4x4に4レベル以上は無い
+    Archive archive;
+    archive.entry.mipLevels = 4;
+    CHECK(Open(reader, archive.build()) && reader.find(Name) == nullptr);
+  }
+  {
+    Archive archive;
+    archive.entry.width = 0;
+    CHECK(Open(reader, archive.build()) && reader.find(Name) == nullptr);
+  }
+}
@@ -0,0 +1,73 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "camera.h"
+#include <cmath>
+#include <vector>
+
+// 4点ずつの計算と端数を、viewProjection * p から1点ずつ求めたものと比べる
+TEST_CASE(CameraProjectToScreen)
+{
+  constexpr float Near = 0.1f;
+  auto            size = simd_make_float2(640.0f, 360.0f);
+
+  CameraData camera;
+  camera.buildPerspective(1.0f, size.x / size.y, Near, 100.0f);
+  camera.buildModelView(simd_make_float3(1.0f, 2.0f, 5.0f),
+                        simd_make_float3(0.0f, 0.0f, 0.0f),
+                        simd_make_float3(0.0f, 1.0f, 0.0f));
+
+  // 4の倍数でない数。視点の後ろとnearより手前の点を4点組と端数の両方に混ぜる
+  std::vector<simd_float3> points;
+  for (int i = 0; i < 23; i++)
+  {
+    auto f = (float)i;
+    points.push_back(simd_make_float3(std::sin(f) * 3.0f, std::cos(f * 1.3f) * 2.0f, 3.0f - f));
+  }
+  auto eye   = camera.getEyePosition();
+  auto front = simd_normalize(camera.getLookAt() - eye);
+  for (int i : {1, 6, 21})
+  {
+    points[i] = eye - front * (float)i; // 後ろ
+  }
+  for (int i : {9, 22})
+  {
+    points[i] = eye + front * (Near * 0.5f); // nearより手前
+  }
+
+  std::vector<simd_float2> screen(points.size());
+  std::vector<uint8_t>     visible(points.size(), 0xff);
+  auto nbVisible = camera.projectToScreen(points, size, screen, visible);
+
+  const auto &vp        = camera.getViewProjectionMatrix();
+  size_t      expect    = 0;
+  float       maxError  = 0.0f;
+  bool        sameFlags = true;
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    auto clip  = simd_mul(vp, simd_make_float4(points[i], 1.0f));
+    bool front = clip.w >= Near;
+    sameFlags  = sameFlags && visible[i] == (front ? 1 : 0);
+    if (!front)
+    {
+      continue;
+    }
+    expect++;
+    auto want = simd_make_float2((clip.x / clip.w + 1.0f) * size.x * 0.5f,
+                                 (1.0f - clip.y / clip.w) * size.y * 0.5f);
+    auto d    = screen[i] - want;
+    maxError  = std::max(maxError, std::sqrt(simd_dot(d, d)));
+  }
+  CHECK(sameFlags);
+  CHECK(expect == points.size() - 5);
+  CHECK(nbVisible == expect);
+  CHECK(maxError < 1.0e-2f);
+
+  // 数は一番短いものに合わせ、その先には書かない
+  std::vector<uint8_t> shortVisible(10, 0xff);
+  screen.assign(points.size(), simd_make_float2(-1.0f, -1.0f));
+  nbVisible = camera.projectToScreen(points, size, screen, shortVisible);
+  CHECK(nbVisible == 7); // 1, 6, 9が見えない
+  CHECK(screen[10].x == -1.0f);
+}
@@ -0,0 +1,102 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "command_list2d.h"
+#include "prim2d_geometry.h"
+#include <vector>
+
+namespace
+{
+
+using Commands = CommandList2D<const void *, const void *>;
+
+struct Vertex2D
+{
+  simd_float2 position;
+  float16x4_t color;
+};
+
+struct Item
+{
+  float value;
+  bool  shown;
+};
+
+} // namespace
+
+// 見えるものだけが詰めて書かれ、余った分は返されて1つのコマンドにまとまる
+TEST_CASE(WriteVisibleGivesBackTail)
+{
+  std::vector<Item> items(3000);
+  size_t            shown = 0;
+  for (size_t i = 0; i < items.size(); i++)
+  {
+    items[i] = {(float)i, i % 3 == 0};
+    shown += items[i].shown ? 1 : 0;
+  }
+
+  Commands::TextureIds  ids;
+  Commands              list;
+  std::vector<Vertex2D> vertices(items.size() * 2);
+  size_t                counter = 0;
+  list.reset(&ids);
+
+  Prim2D::WriteVisible(
+      items.data(),
+      items.size(),
+      2,
+      [](const Item &item) { return item.shown; },
+      [&](size_t nbVertices) -> Vertex2D *
+      {
+        auto start = list.reserve(nbVertices,
+                                  PipelineLine,
+                                  0,
+                                  NoClip,
+                                  vertices.data(),
+                                  nullptr,
+                                  counter,
+                                  vertices.size(),
+                                  nullptr);
+        return start == Commands::NoSpace ? nullptr : vertices.data() + start;
+      },
+      [](Vertex2D *vtx2d, const Item &item)
+      { vtx2d[0].position = vtx2d[1].position = simd_make_float2(item.value, 0.0f); },
+      [&](Vertex2D *end, size_t unused)
+      { CHECK(list.shrink(vertices.data(), counter, end - vertices.data(), unused)); });
+
+  CHECK(counter == shown * 2);
+  CHECK(list.commands().size() == 1);
+  CHECK(list.commands()[0].vertexCount_ == shown * 2);
+  bool ordered = true;
+  for (size_t i = 0; i < shown; i++)
+  {
+    ordered = ordered && vertices[i * 2].position.x == (float)(i * 3);
+  }
+  CHECK(ordered);
+}
+
+// 後から別の確保があった時は返せない
+TEST_CASE(CommandListShrinkAfterOtherReserve)
+{
+  Commands::TextureIds ids;
+  Commands             list;
+  size_t               counter = 0;
+  list.reset(&ids);
+
+  int  buffer = 0;
+  auto first  = list.reserve(10, PipelineFill, 0, NoClip, &buffer, nullptr, counter, 100, nullptr);
+  auto second = list.reserve(10, PipelineFill, 1, NoClip, &buffer, nullptr, counter, 100, nullptr);
+  CHECK(first == 0);
+  CHECK(second == 10);
+  CHECK(list.commands().size() == 2);
+  CHECK(!list.shrink(&buffer, counter, first + 4, 6));
+  CHECK(counter == 20);
+
+  // 最後の確保は全部返すとコマンドも消える
+  CHECK(list.shrink(&buffer, counter, second, 10));
+  CHECK(counter == 10);
+  CHECK(list.commands().size() == 1);
+  CHECK(list.reserve(100, PipelineFill, 0, NoClip, &buffer, nullptr, counter, 100, nullptr) ==
+        Commands::NoSpace);
+}
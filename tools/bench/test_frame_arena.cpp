@@ -0,0 +1,115 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "frame_arena.h"
+#include <atomic>
+#include <cstdlib>
+#include <list>
+#include <string>
+#include <thread>
+
+//
+// ヒープ割り当ての回数を数える(このプログラム全体のnew/deleteを置き換える)
+//
+namespace
+{
+std::atomic<size_t> HeapAllocations{0};
+} // namespace
+
+void *operator new(size_t size)
+{
+  HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto *ptr = std::malloc(size != 0 ? size : 1))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+void *operator new[](size_t size) { return operator new(size); }
+void  operator delete(void *ptr) noexcept { std::free(ptr); }
+void  operator delete[](void *ptr) noexcept { std::free(ptr); }
+void  operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void  operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+
+namespace
+{
+
+// Draw2DのFrameData2Dと同じ使い方
+struct FrameData
+{
+  std::pmr::list<std::pmr::string>          strings;
+  std::pmr::vector<uint32_t>                indices;
+  std::pmr::unordered_map<void *, uint32_t> ids;
+
+  explicit FrameData(std::pmr::memory_resource *resource)
+      : strings(resource), indices(resource), ids(resource)
+  {
+  }
+};
+
+void RunFrame(FrameArena &arena, int frame)
+{
+  auto *data = arena.create<FrameData>(arena.resource());
+  for (uint32_t i = 0; i < 1000; i++)
+  {
+    data->indices.push_back(i);
+    data->ids.try_emplace(reinterpret_cast<void *>(uintptr_t(i + 1) * 16), i);
+  }
+  for (int i = 0; i < 100; i++)
+  {
+    data->strings.emplace_back("a string longer than the small buffer optimization", frame);
+  }
+  auto *array = arena.allocateArray<float>(64 * 1024);
+  Bench::Keep(array);
+  data->~FrameData();
+  arena.reset();
+}
+
+} // namespace
+
+// 温まった後のフレームではヒープから確保しない
+TEST_CASE(FrameArenaNoHeapAfterWarmup)
+{
+  FrameArena arena{64 * 1024};
+  for (int frame = 0; frame < 3; frame++)
+  {
+    RunFrame(arena, frame);
+  }
+  auto chunks = arena.stats().chunkAllocations;
+  auto before = HeapAllocations.load();
+  CHECK(before > 0);
+  for (int frame = 3; frame < 10; frame++)
+  {
+    RunFrame(arena, frame);
+  }
+  CHECK(HeapAllocations.load() == before);
+  CHECK(arena.stats().chunkAllocations == chunks);
+}
+
+// 別のスレッドが割り当て中でもstats()を呼べる
+TEST_CASE(FrameArenaStatsWhileAllocating)
+{
+  FrameArena        arena{4 * 1024};
+  std::atomic<bool> done{false};
+  std::thread       worker(
+      [&]
+      {
+        for (int i = 0; i < 100000; i++)
+        {
+          Bench::Keep(arena.allocate(64));
+        }
+        done = true;
+      });
+  size_t last  = 0;
+  bool   grows = true;
+  while (!done)
+  {
+    auto used = arena.stats().bytesUsed;
+    grows     = grows && used >= last;
+    last      = used;
+  }
+  worker.join();
+  CHECK(grows);
+  CHECK(arena.stats().bytesUsed == 64 * 100000);
+}
@@ -0,0 +1,112 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "command_list2d.h"
+#include "frame_hash.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using Commands = CommandList2D<const void *, const void *>;
+
+uint64_t Hash(const char *text, uint64_t seed = 0)
+{
+  return FrameHash::Compute(text, std::strlen(text), seed);
+}
+
+// テクスチャとバッファの代わり
+int Buffer;
+int Textures[3];
+
+// 線・スプライト・文字列を1つずつ記録したフレームのハッシュ
+struct Frame
+{
+  uint32_t    layer     = 0x8000;
+  uint32_t    clip      = NoClip;
+  size_t      lineCount = 2;
+  Pipeline2D  pipeline  = PipelineLine;
+  uint32_t    instance  = NoInstance;
+  const void *sprite    = &Textures[0];
+  const void *text      = &Textures[1];
+
+  uint64_t hash() const
+  {
+    Commands::TextureIds ids;
+    Commands             list;
+    size_t               counter = 0;
+    list.reset(&ids);
+    list.reserve(lineCount, pipeline, layer, clip, &Buffer, nullptr, counter, 100, nullptr);
+    list.reserve(6, PipelineSprite, layer, NoClip, &Buffer, sprite, counter, 100, nullptr);
+    list.reserve(6, PipelineText, layer, NoClip, &Buffer, text, counter, 100, nullptr);
+    list.commands()[0].instance_ = instance;
+
+    FrameHash hash;
+    list.addHash(hash);
+    return hash.digest();
+  }
+};
+
+} // namespace
+
+// XXH64の公開されている値と一致する
+TEST_CASE(FrameHashVectors)
+{
+  CHECK(Hash("") == 0xEF46DB3751D8E999ULL);
+  CHECK(Hash("a") == 0xD24EC4F1A98C6E5BULL);
+  CHECK(Hash("abc") == 0x44BC2CF5AD770999ULL);
+  CHECK(Hash("Nobody inspects the spammish repetition") == 0xFBCEA83C8A378BF1ULL);
+  CHECK(Hash("", 1) != Hash(""));
+}
+
+// 少しずつ渡しても一度に渡しても同じ値になる
+TEST_CASE(FrameHashChunked)
+{
+  std::string data;
+  for (int i = 0; i < 1000; i++)
+  {
+    data += (char)(i * 7 + 3);
+  }
+  auto whole = FrameHash::Compute(data.data(), data.size());
+  for (size_t step : {1, 3, 7, 31, 32, 33, 100})
+  {
+    FrameHash hash;
+    for (size_t pos = 0; pos < data.size(); pos += step)
+    {
+      hash.update(data.data() + pos, std::min(step, data.size() - pos));
+    }
+    CHECK(hash.digest() == whole);
+  }
+}
+
+// コマンドのどの値が変わってもハッシュが変わる
+// 文字列のテクスチャは毎フレーム作り直すので含めない(内容はDraw2Dが別に加える)
+TEST_CASE(FrameHashCommands)
+{
+  auto base = Frame{}.hash();
+  CHECK(Frame{}.hash() == base);
+
+  std::vector<std::function<void(Frame &)>> changes = {
+      [](Frame &frame) { frame.layer++; },
+      [](Frame &frame) { frame.clip = 1; },
+      [](Frame &frame) { frame.lineCount = 4; },
+      [](Frame &frame) { frame.pipeline = PipelineFill; },
+      [](Frame &frame) { frame.instance = 0; },
+      [](Frame &frame) { frame.sprite = &Textures[2]; },
+  };
+  for (auto &change : changes)
+  {
+    Frame frame;
+    change(frame);
+    CHECK(frame.hash() != base);
+  }
+
+  Frame text;
+  text.text = &Textures[2];
+  CHECK(text.hash() == base);
+}
@@ -0,0 +1,217 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "image_filter.h"
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+
+namespace
+{
+
+using ImageFilter::ImageF;
+
+// 全画素が同じ色の画像
+ImageF Fill(uint32_t width, uint32_t height, std::initializer_list<float> rgba)
+{
+  ImageF img;
+  img.resize(width, height);
+  for (size_t i = 0; i < img.pixels.size(); i++)
+  {
+    img.pixels[i] = rgba.begin()[i & 3];
+  }
+  return img;
+}
+
+float *Pixel(ImageF &img, uint32_t x, uint32_t y)
+{
+  return img.pixels.data() + ((size_t)y * img.width + x) * 4;
+}
+
+bool Near(const float *pixel, std::initializer_list<float> rgba)
+{
+  for (int c = 0; c < 4; c++)
+  {
+    if (std::abs(pixel[c] - rgba.begin()[c]) > 1.0e-5f)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+// clear()の後は元の画像が出力になる
+TEST_CASE(FilterGraphClear)
+{
+  std::array<uint8_t, 16> src{255, 0, 0, 255, 0, 255, 0, 255, 0, 0, 255, 255, 255, 255, 255, 255};
+  ImageFilter::Graph      graph;
+  graph.setSource(src.data(), 2, 2, 8);
+  graph.add<ImageFilter::Threshold>(0.5f);
+  CHECK(graph.process());
+  CHECK(std::memcmp(graph.output(), src.data(), src.size()) != 0);
+  CHECK(!graph.process());
+
+  graph.clear();
+  CHECK(graph.isDirty());
+  CHECK(graph.process());
+  CHECK(std::memcmp(graph.output(), src.data(), src.size()) == 0);
+  CHECK(!graph.isDirty());
+  CHECK(!graph.process());
+}
+
+// 5x5の中心だけ0.9の画像を半径1でぼかすと3x3が0.1になる(他は0のまま)
+TEST_CASE(FilterBoxBlur)
+{
+  auto src            = Fill(5, 5, {0.0f, 0.0f, 0.0f, 1.0f});
+  Pixel(src, 2, 2)[0] = 0.9f;
+  ImageFilter::BoxBlur blur{1};
+  ImageF               dst;
+  blur.apply(src, dst);
+  bool ok = true;
+  for (uint32_t y = 0; y < 5; y++)
+  {
+    for (uint32_t x = 0; x < 5; x++)
+    {
+      bool inside = x >= 1 && x <= 3 && y >= 1 && y <= 3;
+      ok          = ok && Near(Pixel(dst, x, y), {inside ? 0.1f : 0.0f, 0.0f, 0.0f, 1.0f});
+    }
+  }
+  CHECK(ok);
+
+  // 端は端の画素を繰り返す(3x1の[0, 0.9, 0]は全部0.3)
+  auto row            = Fill(3, 1, {0.0f, 0.0f, 0.0f, 0.0f});
+  Pixel(row, 1, 0)[1] = 0.9f;
+  blur.apply(row, dst);
+  CHECK(Near(Pixel(dst, 0, 0), {0.0f, 0.3f, 0.0f, 0.0f}));
+  CHECK(Near(Pixel(dst, 2, 0), {0.0f, 0.3f, 0.0f, 0.0f}));
+}
+
+// sigma 0.5(半径2)の重みは exp(-k^2 / 0.5) を合計1にしたもの
+TEST_CASE(FilterGaussianBlur)
+{
+  float w1    = std::exp(-2.0f);
+  float w2    = std::exp(-8.0f);
+  float total = 1.0f + 2.0f * (w1 + w2);
+
+  auto src            = Fill(5, 5, {0.0f, 0.0f, 0.0f, 0.0f});
+  Pixel(src, 2, 2)[3] = 1.0f;
+  ImageFilter::GaussianBlur blur{0.5f};
+  ImageF                    dst;
+  blur.apply(src, dst);
+  CHECK(Near(Pixel(dst, 2, 2), {0.0f, 0.0f, 0.0f, 1.0f / (total * total)}));
+  CHECK(Near(Pixel(dst, 3, 2), {0.0f, 0.0f, 0.0f, w1 / (total * total)}));
+  CHECK(Near(Pixel(dst, 0, 4), {0.0f, 0.0f, 0.0f, w2 * w2 / (total * total)}));
+
+  float sum = 0.0f;
+  for (size_t i = 3; i < dst.pixels.size(); i += 4)
+  {
+    sum += dst.pixels[i];
+  }
+  CHECK(std::abs(sum - 1.0f) < 1.0e-5f);
+}
+
+// RとBの入れ替え、Gの半分+バイアス、アルファ半分。範囲外は0..1に収める
+TEST_CASE(FilterColorMatrix)
+{
+  // clang-format off
+  const float matrix[20] = {
+    0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.5f, 0.0f, 0.0f, 0.1f,
+    1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 0.5f, 0.0f,
+  };
+  const float overflow[20] = {
+    1.0f, 0.0f, 0.0f, 0.0f,  2.0f,
+    0.0f, 1.0f, 0.0f, 0.0f, -2.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,  0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f,  0.0f,
+  };
+  // clang-format on
+  auto                     src = Fill(2, 2, {0.2f, 0.4f, 0.6f, 1.0f});
+  ImageF                   dst;
+  ImageFilter::ColorMatrix identity;
+  identity.apply(src, dst);
+  CHECK(Near(Pixel(dst, 1, 1), {0.2f, 0.4f, 0.6f, 1.0f}));
+
+  ImageFilter::ColorMatrix swap;
+  swap.setMatrix(matrix);
+  swap.apply(src, dst);
+  CHECK(Near(Pixel(dst, 1, 1), {0.6f, 0.3f, 0.2f, 0.5f}));
+
+  swap.setMatrix(overflow);
+  swap.apply(src, dst);
+  CHECK(Near(Pixel(dst, 0, 0), {1.0f, 0.0f, 0.6f, 1.0f}));
+}
+
+// 輝度 0.2126R + 0.7152G + 0.0722B を使う
+TEST_CASE(FilterThresholdTint)
+{
+  auto   src       = Fill(1, 1, {0.2f, 0.4f, 0.6f, 0.8f});
+  float  luminance = 0.2f * 0.2126f + 0.4f * 0.7152f + 0.6f * 0.0722f;
+  ImageF dst;
+
+  ImageFilter::Threshold threshold{0.5f};
+  threshold.apply(src, dst);
+  CHECK(Near(Pixel(dst, 0, 0), {0.0f, 0.0f, 0.0f, 0.8f}));
+  threshold.setLevel(luminance);
+  threshold.apply(src, dst);
+  CHECK(Near(Pixel(dst, 0, 0), {1.0f, 1.0f, 1.0f, 0.8f}));
+
+  // 赤に半分寄せる
+  ImageFilter::Tint tint{1.0f, 0.0f, 0.0f, 0.5f};
+  tint.apply(src, dst);
+  CHECK(Near(Pixel(dst, 0, 0), {(0.2f + luminance) * 0.5f, 0.2f, 0.3f, 0.8f}));
+}
+
+// 段をつないだ出力は1段ずつ掛けたものと同じ
+TEST_CASE(FilterGraphChain)
+{
+  // clang-format off
+  const float invert[20] = {
+    -1.0f,  0.0f,  0.0f, 0.0f, 1.0f,
+     0.0f, -1.0f,  0.0f, 0.0f, 1.0f,
+     0.0f,  0.0f, -1.0f, 0.0f, 1.0f,
+     0.0f,  0.0f,  0.0f, 1.0f, 0.0f,
+  };
+  // clang-format on
+  std::array<uint8_t, 12> src{0, 51, 255, 255, 255, 102, 0, 255, 51, 51, 51, 255};
+
+  ImageFilter::Graph graph;
+  graph.setSource(src.data(), 3, 1, 12);
+  auto matrix = graph.add<ImageFilter::ColorMatrix>();
+  matrix->setMatrix(invert);
+  graph.add<ImageFilter::BoxBlur>(1);
+  CHECK(graph.process());
+
+  // 反転: [1, 0.8, 0] [0, 0.6, 1] [0.8, 0.8, 0.8]
+  // ぼかし(端は繰り返し): [(1 + 1 + 0)/3, (0.8 + 0.8 + 0.6)/3, (0 + 0 + 1)/3] ...
+  const uint8_t expect[12] = {170, 187, 85, 255, 153, 187, 153, 255, 136, 187, 221, 255};
+  CHECK(std::memcmp(graph.output(), expect, sizeof(expect)) == 0);
+}
+
+// sRGBのソースはリニアでフィルタを掛けてsRGBに戻す
+TEST_CASE(FilterGraphSRGB)
+{
+  std::array<uint8_t, 8> src{0, 0, 0, 128, 255, 255, 255, 128};
+
+  // 段が無ければそのまま戻る
+  ImageFilter::Graph graph;
+  graph.setSource(src.data(), 2, 1, 8, true);
+  CHECK(graph.process());
+  CHECK(std::memcmp(graph.output(), src.data(), src.size()) == 0);
+
+  // 黒と白を半径1でぼかすとリニアで1/3と2/3。sRGBでは156と213(アルファはリニアのまま)
+  graph.add<ImageFilter::BoxBlur>(1);
+  CHECK(graph.process());
+  const uint8_t srgb[8] = {156, 156, 156, 128, 213, 213, 213, 128};
+  CHECK(std::memcmp(graph.output(), srgb, sizeof(srgb)) == 0);
+
+  graph.setSource(src.data(), 2, 1, 8, false);
+  CHECK(graph.process());
+  const uint8_t linear[8] = {85, 85, 85, 128, 170, 170, 170, 128};
+  CHECK(std::memcmp(graph.output(), linear, sizeof(linear)) == 0);
+}
@@ -0,0 +1,131 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "job_system.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+// 入れ子のparallelForでも全ての番号をちょうど1回ずつ処理する
+TEST_CASE(JobNestedParallelFor)
+{
+  constexpr size_t Rows    = 64;
+  constexpr size_t Columns = 1000;
+
+  JobSystem system{3};
+  auto      visited = std::make_unique<std::atomic<int>[]>(Rows * Columns);
+  for (int repeat = 0; repeat < 10; repeat++)
+  {
+    for (size_t i = 0; i < Rows * Columns; i++)
+    {
+      visited[i].store(0, std::memory_order_relaxed);
+    }
+    system.parallelFor(Rows,
+                       1,
+                       [&](size_t rowBegin, size_t rowEnd)
+                       {
+                         for (size_t row = rowBegin; row < rowEnd; row++)
+                         {
+                           system.parallelFor(Columns,
+                                              16,
+                                              [&, row](size_t begin, size_t end)
+                                              {
+                                                for (size_t col = begin; col < end; col++)
+                                                {
+                                                  visited[row * Columns + col].fetch_add(1);
+                                                }
+                                              });
+                         }
+                       });
+    size_t wrong = 0;
+    for (size_t i = 0; i < Rows * Columns; i++)
+    {
+      wrong += visited[i].load() != 1 ? 1 : 0;
+    }
+    CHECK(wrong == 0);
+  }
+}
+
+// then()は全てのジョブが終わった後に1回だけ実行される(ジョブが無くても)
+TEST_CASE(JobTaskGroupThen)
+{
+  JobSystem system{3};
+  for (int repeat = 0; repeat < 200; repeat++)
+  {
+    size_t           tasks = repeat % 2 == 0 ? 0 : 100;
+    std::atomic<int> done{0};
+    std::atomic<int> calls{0};
+    std::atomic<int> seen{-1};
+    {
+      JobSystem::TaskGroup group{system};
+      for (size_t i = 0; i < tasks; i++)
+      {
+        group.run([&] { done.fetch_add(1); });
+      }
+      group.then(
+          [&]
+          {
+            seen.store(done.load());
+            calls.fetch_add(1);
+          });
+      group.wait();
+      CHECK(calls.load() == 1);
+    }
+    CHECK(calls.load() == 1);
+    CHECK(seen.load() == (int)tasks);
+  }
+}
+
+// ワーカーのキュー(4096)に入りきらない分は投入したワーカーがその場で実行する
+TEST_CASE(JobInlineWhenQueueFull)
+{
+  constexpr int Jobs = 5000;
+
+  JobSystem          system{1};
+  std::atomic<int>   count{0};
+  JobSystem::Counter outer;
+  system.run(outer,
+             [&]
+             {
+               JobSystem::Counter inner;
+               for (int i = 0; i < Jobs; i++)
+               {
+                 system.run(inner, [&] { count.fetch_add(1); });
+               }
+               system.wait(inner);
+             });
+  // 呼び出し元はジョブを取らずに待つ(ワーカーは1つなので誰も盗まない)
+  while (!outer.done())
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  system.endFrame();
+
+  auto stats = system.frameStats();
+  CHECK(count.load() == Jobs);
+  CHECK(stats.inlined == Jobs - 4096);
+  CHECK(stats.executed == Jobs + 1);
+  CHECK(stats.stolen == 0);
+}
+
+// endFrame()はフレームのジョブを待ってから、そのフレームの統計を取る
+TEST_CASE(JobFrameStats)
+{
+  JobSystem        system{2};
+  std::atomic<int> count{0};
+  for (int i = 0; i < 100; i++)
+  {
+    system.runFrame([&] { count.fetch_add(1); });
+  }
+  system.endFrame();
+  auto stats = system.frameStats();
+  CHECK(count.load() == 100);
+  CHECK(stats.executed == 100);
+  CHECK(stats.inlined == 0);
+  CHECK(stats.stolen <= stats.executed);
+
+  system.endFrame();
+  CHECK(system.frameStats().executed == 0);
+}
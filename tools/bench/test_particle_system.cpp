@@ -0,0 +1,164 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "particle_system.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+// 位置xを番号にして1つずつ発生させる(速度0で外力なし)
+void EmitTagged(Particle::System &system, size_t count, float (*life)(size_t))
+{
+  Particle::EmitterDesc desc;
+  desc.velocity = simd_make_float3(0.0f, 0.0f, 0.0f);
+  for (size_t id = 0; id < count; id++)
+  {
+    desc.position = simd_make_float3((float)id, 0.0f, 0.0f);
+    desc.lifeMin  = life(id);
+    desc.lifeMax  = life(id);
+    system.setEmitter(desc);
+    system.emit(1);
+  }
+}
+
+// 生きている粒子の番号(昇順)
+std::vector<size_t> LiveIds(const Particle::System &system)
+{
+  std::vector<Particle::Vertex> vertices(system.size());
+  system.writeAll(vertices.data());
+  std::vector<size_t> ids;
+  for (const auto &vtx : vertices)
+  {
+    ids.push_back((size_t)vtx.position.x);
+  }
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+} // namespace
+
+// 寿命に達したフレームで消える
+TEST_CASE(ParticleLifetime)
+{
+  Particle::System system{16};
+  EmitTagged(system, 10, [](size_t) { return 1.0f; });
+  for (int frame = 0; frame < 3; frame++)
+  {
+    system.update(0.25f);
+    CHECK(system.size() == 10);
+  }
+  system.update(0.25f);
+  CHECK(system.size() == 0);
+}
+
+// 複数のチャンクにまたがって消えても、残った粒子の数と中身が合っている
+TEST_CASE(ParticleSwapRemoval)
+{
+  // 4の倍数でもチャンク(16K)の倍数でもない数
+  constexpr size_t Count = 50003;
+  // 寿命は(0..9)+1.05フレーム分。番号によってばらばらに消える
+  auto life = [](size_t id) { return ((float)(id * 7919 % 10) + 1.05f) * 0.1f; };
+
+  Particle::System system{Count};
+  EmitTagged(system, Count, life);
+  for (int frame = 1; frame <= 11; frame++)
+  {
+    system.update(0.1f);
+    std::vector<size_t> expect;
+    for (size_t id = 0; id < Count; id++)
+    {
+      if ((int)(id * 7919 % 10) + 1 >= frame)
+      {
+        expect.push_back(id);
+      }
+    }
+    CHECK(system.size() == expect.size());
+    CHECK(LiveIds(system) == expect);
+  }
+  CHECK(system.size() == 0);
+}
+
+// 4粒子ずつの積分と色の表引きを1粒子ずつ計算したものと比べる
+TEST_CASE(ParticleWriteAllMatchesScalar)
+{
+  constexpr size_t Count = 40001;
+  constexpr float  Dt    = 1.0f / 60.0f;
+  constexpr float  Scale = 2.0f;
+
+  Particle::Forces forces;
+  forces.gravity = simd_make_float3(0.0f, -9.8f, 0.0f);
+  forces.wind    = simd_make_float3(3.0f, 0.0f, -1.0f);
+  forces.drag    = 0.5f;
+  Particle::ColorCurve curve{simd_make_float4(1.0f, 0.0f, 0.0f, 1.0f),
+                             simd_make_float4(0.0f, 0.0f, 1.0f, 0.0f)};
+  curve.addKey(0.5f, simd_make_float4(0.0f, 1.0f, 0.0f, 1.0f));
+
+  Particle::System system{Count};
+  system.setForces(forces);
+  system.setColorCurve(curve);
+
+  struct Scalar
+  {
+    simd_float3 pos;
+    simd_float3 vel;
+    float       life;
+  };
+  std::vector<Scalar>   ref(Count);
+  Particle::EmitterDesc desc;
+  desc.sizeStart = 1.0f;
+  desc.sizeEnd   = 5.0f;
+  for (size_t i = 0; i < Count; i++)
+  {
+    auto f        = (float)i;
+    ref[i].pos    = simd_make_float3(std::sin(f), std::cos(f), f * 0.001f);
+    ref[i].vel    = simd_make_float3(std::cos(f * 0.3f), 2.0f, std::sin(f * 0.7f));
+    ref[i].life   = 1.0f + (float)(i % 100) * 0.01f;
+    desc.position = ref[i].pos;
+    desc.velocity = ref[i].vel;
+    desc.lifeMin  = ref[i].life;
+    desc.lifeMax  = ref[i].life;
+    system.setEmitter(desc);
+    system.emit(1);
+  }
+
+  float damp = std::exp(-forces.drag * Dt);
+  for (int frame = 0; frame < 30; frame++)
+  {
+    system.update(Dt);
+    for (auto &p : ref)
+    {
+      p.vel = forces.wind + (p.vel - forces.wind) * damp + forces.gravity * Dt;
+      p.pos += p.vel * Dt;
+    }
+  }
+  CHECK(system.size() == Count);
+
+  std::vector<Particle::Vertex> vertices(Count);
+  system.writeAll(vertices.data(), Scale);
+  float age       = Dt * 30;
+  float posError  = 0.0f;
+  float sizeError = 0.0f;
+  float colError  = 0.0f;
+  for (size_t i = 0; i < Count; i++)
+  {
+    const auto &vtx = vertices[i];
+    auto        t   = std::min(age / ref[i].life, 1.0f);
+    auto        d   = vtx.position - ref[i].pos * Scale;
+    posError        = std::max(posError, std::sqrt(simd_dot(d, d)));
+    sizeError = std::max(sizeError, std::abs(vtx.size - (1.0f + 4.0f * t) * Scale));
+    auto color = curve.evaluate(t);
+    for (int c = 0; c < 4; c++)
+    {
+      auto want = c == 0 ? color.x : c == 1 ? color.y : c == 2 ? color.z : color.w;
+      colError  = std::max(colError, std::abs((float)vtx.color[c] - want));
+    }
+  }
+  // 色は64段の表なので1段分(傾き2)までずれる
+  CHECK(posError < 1.0e-3f);
+  CHECK(sizeError < 1.0e-3f);
+  CHECK(colError < 2.0f / Particle::ColorCurve::TableSize + 1.0e-2f);
+}
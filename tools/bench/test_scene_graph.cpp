@@ -0,0 +1,158 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "scene_graph.h"
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+using Scene::Transform;
+
+Transform MakeTransform(simd_float3 position, float angle, simd_float3 axis, simd_float3 scale)
+{
+  Transform t;
+  t.position = position;
+  t.rotation = simd_quaternion(angle, axis);
+  t.scale    = scale;
+  return t;
+}
+
+// 平行移動 * 回転 * 拡大縮小 を別々の行列の積で作る
+simd_float4x4 Compose(const Transform &t)
+{
+  auto translate = simd_matrix(simd_make_float4(1.0f, 0.0f, 0.0f, 0.0f),
+                               simd_make_float4(0.0f, 1.0f, 0.0f, 0.0f),
+                               simd_make_float4(0.0f, 0.0f, 1.0f, 0.0f),
+                               simd_make_float4(t.position, 1.0f));
+
+  auto scale = simd_matrix(simd_make_float4(t.scale.x, 0.0f, 0.0f, 0.0f),
+                           simd_make_float4(0.0f, t.scale.y, 0.0f, 0.0f),
+                           simd_make_float4(0.0f, 0.0f, t.scale.z, 0.0f),
+                           simd_make_float4(0.0f, 0.0f, 0.0f, 1.0f));
+  return simd_mul(translate, simd_mul(simd_matrix4x4(t.rotation), scale));
+}
+
+// 根から順にローカル行列を掛ける
+simd_float4x4 Expected(const Scene::Graph &graph, Scene::NodeId id)
+{
+  auto world = Compose(graph.local(id));
+  for (auto p = graph.parent(id); p != Scene::InvalidNode; p = graph.parent(p))
+  {
+    world = simd_mul(Compose(graph.local(p)), world);
+  }
+  return world;
+}
+
+bool Near(const simd_float4x4 &a, const simd_float4x4 &b)
+{
+  for (int c = 0; c < 4; c++)
+  {
+    auto d = a.columns[c] - b.columns[c];
+    if (std::sqrt(simd_dot(d, d)) > 1.0e-4f)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MatchesAll(const Scene::Graph &graph)
+{
+  for (auto id : graph.ids())
+  {
+    if (!Near(graph.world(id), Expected(graph, id)))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+// 付け替えと親の移動の後も、ワールド行列が親からの積と一致する
+TEST_CASE(SceneGraphReparent)
+{
+  auto axisY = simd_make_float3(0.0f, 1.0f, 0.0f);
+  auto axisZ = simd_make_float3(0.0f, 0.0f, 1.0f);
+
+  Scene::Graph graph;
+  auto a = graph.create(Scene::InvalidNode,
+                        MakeTransform(simd_make_float3(1.0f, 2.0f, 3.0f),
+                                      0.5f,
+                                      axisY,
+                                      simd_make_float3(2.0f, 2.0f, 2.0f)));
+  auto b = graph.create(a,
+                        MakeTransform(simd_make_float3(0.0f, 1.0f, 0.0f),
+                                      1.0f,
+                                      axisZ,
+                                      simd_make_float3(1.0f, 0.5f, 1.0f)));
+  auto c = graph.create(b,
+                        MakeTransform(simd_make_float3(3.0f, 0.0f, -1.0f),
+                                      -0.3f,
+                                      axisY,
+                                      simd_make_float3(1.0f, 1.0f, 3.0f)));
+  auto d = graph.create(Scene::InvalidNode,
+                        MakeTransform(simd_make_float3(-5.0f, 0.0f, 0.0f),
+                                      2.0f,
+                                      axisZ,
+                                      simd_make_float3(1.0f, 1.0f, 1.0f)));
+  graph.update();
+  CHECK(MatchesAll(graph));
+
+  // bを子ごとdの下へ
+  CHECK(graph.setParent(b, d));
+  graph.update();
+  CHECK(graph.parent(b) == d);
+  CHECK(Near(graph.world(c),
+             simd_mul(Compose(graph.local(d)),
+                      simd_mul(Compose(graph.local(b)), Compose(graph.local(c))))));
+  CHECK(Near(graph.world(a), Compose(graph.local(a))));
+  CHECK(MatchesAll(graph));
+
+  // 自分の子孫は親にできない
+  CHECK(!graph.setParent(d, c));
+
+  // 親を動かすと子孫も追従し、他の木は変わらない
+  auto before = graph.world(a);
+  graph.setPosition(d, simd_make_float3(0.0f, 10.0f, 0.0f));
+  graph.setRotation(d, simd_quaternion(-1.0f, axisY));
+  graph.update();
+  CHECK(MatchesAll(graph));
+  CHECK(Near(graph.world(a), before));
+}
+
+// 1段に並列で計算する数より多くぶら下げても同じ
+TEST_CASE(SceneGraphWideLevel)
+{
+  Scene::Graph graph;
+  auto root = graph.create();
+  std::vector<Scene::NodeId> leaves;
+  for (int i = 0; i < 5000; i++)
+  {
+    auto child = graph.create(root,
+                              MakeTransform(simd_make_float3((float)i, 0.0f, 0.0f),
+                                            (float)i * 0.01f,
+                                            simd_make_float3(1.0f, 0.0f, 0.0f),
+                                            simd_make_float3(1.0f, 1.0f, 1.0f)));
+    leaves.push_back(graph.create(child));
+  }
+  graph.update();
+  CHECK(MatchesAll(graph));
+
+  graph.setScale(root, simd_make_float3(0.5f, 2.0f, 1.0f));
+  graph.update();
+  CHECK(MatchesAll(graph));
+
+  // 途中の段を付け替えてから親を動かす
+  for (size_t i = 0; i < leaves.size(); i += 2)
+  {
+    graph.setParent(leaves[i], root);
+  }
+  graph.setPosition(root, simd_make_float3(0.0f, 0.0f, -4.0f));
+  graph.update();
+  CHECK(MatchesAll(graph));
+}
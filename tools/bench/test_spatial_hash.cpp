@@ -0,0 +1,275 @@
+//
+// Copyright 2025 Y.Suzuki(wave.suzuki.z@gmail.com)
+//
+#include "bench.h"
+#include "spatial_hash.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <random>
+#include <utility>
+
+namespace
+{
+
+using Handle = SpatialHash2D::Handle;
+
+// 総当たりで調べる側(外周順の四角形)
+struct Quad
+{
+  std::array<simd_float2, 4> corners; // トライアングルストリップ順(updateに渡すもの)
+  std::array<simd_float2, 4> outline; // 外周順
+  uint64_t                   order;
+};
+
+float Cross(simd_float2 a, simd_float2 b) { return a.x * b.y - a.y * b.x; }
+
+bool Inside(const std::array<simd_float2, 4> &poly, simd_float2 point)
+{
+  bool negative = false;
+  bool positive = false;
+  for (int i = 0; i < 4; i++)
+  {
+    auto c = Cross(poly[(i + 1) & 3] - poly[i], point - poly[i]);
+    negative |= c < 0.0f;
+    positive |= c > 0.0f;
+  }
+  return !(negative && positive);
+}
+
+// 両方の辺の法線で分離軸判定
+bool Touches(const std::array<simd_float2, 4> &a, const std::array<simd_float2, 4> &b)
+{
+  for (const auto *poly : {&a, &b})
+  {
+    for (int i = 0; i < 4; i++)
+    {
+      auto  edge = (*poly)[(i + 1) & 3] - (*poly)[i];
+      auto  axis = simd_make_float2(-edge.y, edge.x);
+      float aLo  = INFINITY;
+      float aHi  = -INFINITY;
+      float bLo  = INFINITY;
+      float bHi  = -INFINITY;
+      for (int k = 0; k < 4; k++)
+      {
+        aLo = std::min(aLo, simd_dot(a[k], axis));
+        aHi = std::max(aHi, simd_dot(a[k], axis));
+        bLo = std::min(bLo, simd_dot(b[k], axis));
+        bHi = std::max(bHi, simd_dot(b[k], axis));
+      }
+      if (aHi < bLo || bHi < aLo)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// 中心・大きさ・角度から作る
+Quad MakeQuad(simd_float2 center, simd_float2 size, float angle, uint64_t order)
+{
+  auto c    = std::cos(angle);
+  auto s    = std::sin(angle);
+  auto axis = [&](float x, float y)
+  { return center + simd_make_float2(x * c - y * s, x * s + y * c); };
+  auto h = size * 0.5f;
+
+  Quad quad;
+  quad.corners = {axis(h.x, -h.y), axis(-h.x, -h.y), axis(h.x, h.y), axis(-h.x, h.y)};
+  quad.outline = {quad.corners[0], quad.corners[1], quad.corners[3], quad.corners[2]};
+  quad.order   = order;
+  return quad;
+}
+
+class Reference
+{
+  std::mt19937           rng_{42};
+  std::map<Handle, Quad> quads_;
+
+public:
+  std::map<Handle, Quad> &quads() { return quads_; }
+
+  float random(float lo, float hi) { return std::uniform_real_distribution<float>{lo, hi}(rng_); }
+
+  // 大きさ8..80(largeなら600..900で、64セルより多くを覆う)
+  Quad randomQuad(bool large)
+  {
+    auto size = large ? simd_make_float2(random(600, 900), random(600, 900))
+                      : simd_make_float2(random(8, 80), random(8, 80));
+    return MakeQuad(simd_make_float2(random(-1000, 1000), random(-1000, 1000)),
+                    size,
+                    random(0, 6.28f),
+                    (uint64_t)(random(0, 1) * 1e9f));
+  }
+
+  // 手前のものから(同じorderは無い前提)
+  std::vector<Handle> sorted(std::vector<Handle> handles)
+  {
+    std::sort(handles.begin(),
+              handles.end(),
+              [&](Handle a, Handle b) { return quads_[a].order > quads_[b].order; });
+    return handles;
+  }
+
+  // 索引と全ての問い合わせが一致するか
+  bool matches(SpatialHash2D &index)
+  {
+    bool ok = index.size() == quads_.size();
+    for (auto &[handle, quad] : quads_)
+    {
+      ok = ok && index.contains(handle);
+    }
+
+    std::vector<Handle> result;
+    for (int i = 0; i < 200; i++)
+    {
+      auto                point = simd_make_float2(random(-1100, 1100), random(-1100, 1100));
+      std::vector<Handle> expect;
+      for (auto &[handle, quad] : quads_)
+      {
+        if (Inside(quad.outline, point))
+        {
+          expect.push_back(handle);
+        }
+      }
+      result.clear();
+      index.queryPoint(point, result);
+      ok = ok && result == sorted(expect);
+    }
+
+    for (int i = 0; i < 100; i++)
+    {
+      auto from = simd_make_float2(random(-1100, 1100), random(-1100, 1100));
+      auto to   = from + simd_make_float2(random(-300, 300), random(-300, 300));
+      auto lo   = simd_min(from, to);
+      auto hi   = simd_max(from, to);
+      std::array<simd_float2, 4> rect{
+          lo, simd_make_float2(hi.x, lo.y), hi, simd_make_float2(lo.x, hi.y)};
+      std::vector<Handle> expect;
+      for (auto &[handle, quad] : quads_)
+      {
+        if (Touches(quad.outline, rect))
+        {
+          expect.push_back(handle);
+        }
+      }
+      result.clear();
+      index.queryRect(from, to, result);
+      ok = ok && result == sorted(expect);
+    }
+
+    std::vector<std::pair<Handle, Handle>> pairs;
+    for (auto &[handle, quad] : quads_)
+    {
+      std::vector<Handle> expect;
+      for (auto &[other, otherQuad] : quads_)
+      {
+        if (other != handle && Touches(quad.outline, otherQuad.outline))
+        {
+          expect.push_back(other);
+          if (handle < other)
+          {
+            pairs.emplace_back(handle, other);
+          }
+        }
+      }
+      result.clear();
+      index.queryOverlaps(handle, result);
+      ok = ok && result == sorted(expect);
+    }
+
+    std::vector<std::pair<Handle, Handle>> found;
+    index.queryPairs(found);
+    for (auto &pair : found)
+    {
+      if (pair.first > pair.second)
+      {
+        std::swap(pair.first, pair.second);
+      }
+    }
+    std::sort(found.begin(), found.end());
+    return ok && found == pairs;
+  }
+};
+
+} // namespace
+
+// 問い合わせの結果が総当たりと一致する(移動・大きな要素・削除を含む)
+TEST_CASE(SpatialHashMatchesBruteForce)
+{
+  Reference     ref;
+  SpatialHash2D index{64.0f, 256};
+  auto         &quads = ref.quads();
+
+  // 番号は飛び飛びにする
+  index.beginFrame();
+  for (Handle i = 0; i < 400; i++)
+  {
+    Handle handle = i * 3 + 1;
+    quads[handle] = ref.randomQuad(i % 50 == 0);
+    index.update(handle, quads[handle].corners.data(), quads[handle].order);
+  }
+  index.sweep();
+  CHECK(ref.matches(index));
+
+  for (int frame = 0; frame < 4; frame++)
+  {
+    index.beginFrame();
+    std::vector<Handle> dropped;
+    int                 n = 0;
+    for (auto &[handle, quad] : quads)
+    {
+      switch (n++ % 10)
+      {
+      case 0:
+        // 更新しないのでsweepで消える
+        dropped.push_back(handle);
+        continue;
+      case 1:
+        // 別のセルへ大きく動かす(大きさも変える)
+        quad = ref.randomQuad(n % 7 == 0);
+        break;
+      case 2:
+        // 少しだけ動かす(セルが変わらないことが多い)
+        for (auto &corner : quad.corners)
+        {
+          corner += simd_make_float2(0.5f, -0.25f);
+        }
+        quad.outline = {quad.corners[0], quad.corners[1], quad.corners[3], quad.corners[2]};
+        break;
+      default:
+        break;
+      }
+      index.update(handle, quad.corners.data(), quad.order);
+    }
+    index.sweep();
+    for (auto handle : dropped)
+    {
+      quads.erase(handle);
+      CHECK(!index.contains(handle));
+    }
+
+    // 明示的に取り除く
+    if (!quads.empty())
+    {
+      auto handle = quads.begin()->first;
+      index.remove(handle);
+      quads.erase(handle);
+    }
+
+    // 新しく加える
+    for (Handle i = 0; i < 20; i++)
+    {
+      Handle handle = 5000 + frame * 100 + i;
+      quads[handle] = ref.randomQuad(i == 0);
+      index.update(handle, quads[handle].corners.data(), quads[handle].order);
+    }
+    CHECK(ref.matches(index));
+  }
+
+  index.clear();
+  quads.clear();
+  CHECK(ref.matches(index));
+}